@@ -0,0 +1,140 @@
+/*
+    Copyright 2011 Even Entem (alias ThiSpawn).
+
+    This file is part of Riot File Translator Plug-in for AutoDesk Maya.
+
+    Autodesk Maya's lib is under :
+    Copyright 1995, 2006, 2008 Autodesk, Inc. All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful, 
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef RIOT__ALIGNEDARRAY_HPP
+#define RIOT__ALIGNEDARRAY_HPP
+
+#include <stdlib.h>
+#include <string.h>
+#if defined(_WIN32)
+#include <malloc.h>
+#endif
+
+namespace riot {
+
+// plain array of POD elements whose storage is aligned for SIMD loads.
+// new elements are zeroed, copies are deep.
+template <class T, int kAlignment = 32>
+class AlignedArray
+{
+public:
+    AlignedArray()
+        : data_(0), size_(0)
+    {
+    }
+
+    explicit AlignedArray(int size)
+        : data_(0), size_(0)
+    {
+        resize(size);
+    }
+
+    AlignedArray(const AlignedArray& other)
+        : data_(0), size_(0)
+    {
+        *this = other;
+    }
+
+    ~AlignedArray()
+    {
+        clear();
+    }
+
+    AlignedArray& operator=(const AlignedArray& other)
+    {
+        if (this != &other)
+        {
+            clear();
+            resize(other.size_);
+            if (size_)
+                memcpy(data_, other.data_, size_ * sizeof(T));
+        }
+        return *this;
+    }
+
+    // keeps the elements already there
+    void resize(int size)
+    {
+        if (size == size_)
+            return;
+
+        T* data = 0;
+        if (size > 0)
+        {
+            data = allocate(size);
+            int kept = size < size_ ? size : size_;
+            if (kept)
+                memcpy(data, data_, kept * sizeof(T));
+            memset(data + kept, 0, (size - kept) * sizeof(T));
+        }
+
+        release(data_);
+        data_ = data;
+        size_ = size > 0 ? size : 0;
+    }
+
+    void clear()
+    {
+        release(data_);
+        data_ = 0;
+        size_ = 0;
+    }
+
+    int size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    T* data() { return data_; }
+    const T* data() const { return data_; }
+
+    T& operator[](int i) { return data_[i]; }
+    const T& operator[](int i) const { return data_[i]; }
+
+private:
+    static T* allocate(int size)
+    {
+#if defined(_WIN32)
+        return reinterpret_cast<T*>(_aligned_malloc(size * sizeof(T), kAlignment));
+#else
+        void* p = 0;
+        if (posix_memalign(&p, kAlignment, size * sizeof(T)) != 0)
+            return 0;
+        return reinterpret_cast<T*>(p);
+#endif
+    }
+
+    static void release(T* data)
+    {
+        if (!data)
+            return;
+#if defined(_WIN32)
+        _aligned_free(data);
+#else
+        free(data);
+#endif
+    }
+
+    T* data_;
+    int size_;
+};
+
+} // namespace riot
+
+#endif
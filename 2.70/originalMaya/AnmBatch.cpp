@@ -0,0 +1,127 @@
+/*
+    Copyright 2011 Even Entem (alias ThiSpawn).
+
+    This file is part of Riot File Translator Plug-in for AutoDesk Maya.
+
+    Autodesk Maya's lib is under :
+    Copyright 1995, 2006, 2008 Autodesk, Inc. All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful, 
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <AnmBatch.h>
+
+#include <maya/MGlobal.h>
+
+#include <AnmReader.h>
+#include <maya_misc.h>
+
+namespace riot {
+
+namespace {
+
+// poses of an opened clip, as AnmReader decodes them (packed)
+long long decodedBytes(const AnmReader& reader)
+{
+    return static_cast<long long>(reader.clipFrames()) * reader.data_.num_bones * kNumPlanes * sizeof(float);
+}
+
+} // namespace
+
+MStatus readAnimations(const std::vector<std::string>& file_names, long long memory_budget,
+                       AnmBatchTarget& target, AnmBatchStats& stats, bool parallel)
+{
+    stats = AnmBatchStats();
+    int num_files = static_cast<int>(file_names.size());
+
+    std::vector<AnmReader*> wave;
+    std::vector<int> indices;
+    std::vector<const char*> errors; // of the workers, displayed here
+    AnmReader* pending = 0; // opened, didn't fit in the last wave
+    int next = 0;
+    MStatus result = MS::kSuccess;
+
+    while (next < num_files && result == MS::kSuccess)
+    {
+        // open as many clips as fit, the first one always
+        long long wave_bytes = 0;
+        while (next < num_files)
+        {
+            AnmReader* reader = pending;
+            pending = 0;
+            if (!reader)
+            {
+                reader = new AnmReader();
+                reader->packed_ = true;
+                if (reader->open(file_names[next].c_str()) != MS::kSuccess)
+                {
+                    delete reader;
+                    target.failed(next);
+                    stats.num_failed++;
+                    next++;
+                    continue;
+                }
+            }
+            long long bytes = decodedBytes(*reader);
+            if (!wave.empty() && wave_bytes + bytes > memory_budget)
+            {
+                pending = reader;
+                break;
+            }
+            wave.push_back(reader);
+            indices.push_back(next);
+            wave_bytes += bytes;
+            next++;
+        }
+        if (wave.empty())
+            break;
+
+        int wave_size = static_cast<int>(wave.size());
+        errors.assign(wave_size, static_cast<const char*>(0));
+
+#pragma omp parallel for schedule(dynamic) if(parallel)
+        for (int i = 0; i < wave_size; i++)
+        {
+            AnmReader& reader = *wave[i];
+            errors[i] = reader.decodeFrames(0, reader.clipFrames());
+            reader.close();
+        }
+
+        stats.num_waves++;
+        if (wave_bytes > stats.peak_bytes)
+            stats.peak_bytes = wave_bytes;
+
+        for (int i = 0; i < wave_size; i++)
+        {
+            if (errors[i])
+            {
+                MGlobal::displayError(MString(errors[i]) + " : " + file_names[indices[i]].c_str());
+                target.failed(indices[i]);
+                stats.num_failed++;
+            }
+            else if (result == MS::kSuccess)
+            {
+                result = target.apply(indices[i], *wave[i]);
+                stats.num_clips++;
+            }
+            delete wave[i];
+        }
+        wave.clear();
+        indices.clear();
+    }
+
+    delete pending;
+    return result;
+}
+
+} // namespace riot
@@ -0,0 +1,69 @@
+/*
+    Copyright 2011 Even Entem (alias ThiSpawn).
+
+    This file is part of Riot File Translator Plug-in for AutoDesk Maya.
+
+    Autodesk Maya's lib is under :
+    Copyright 1995, 2006, 2008 Autodesk, Inc. All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful, 
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef RIOT__ANMBATCH_H
+#define RIOT__ANMBATCH_H
+
+#include <string>
+#include <vector>
+
+#include <maya/MStatus.h>
+
+namespace riot {
+
+class AnmReader;
+
+// what is done with each clip of a batch, on the thread which called
+// readAnimations(), in the order of the files
+class AnmBatchTarget
+{
+public:
+    virtual ~AnmBatchTarget() {}
+
+    // reader.data_ holds the whole clip, packed
+    virtual MStatus apply(int index, AnmReader& reader) = 0;
+    // the clip could not be opened or decoded, readAnimations() displayed
+    // the error before
+    virtual void failed(int /*index*/) {}
+};
+
+struct AnmBatchStats
+{
+    AnmBatchStats() : num_clips(0), num_failed(0), num_waves(0), peak_bytes(0) {}
+
+    int num_clips; // given to apply()
+    int num_failed;
+    int num_waves;
+    long long peak_bytes; // of poses decoded at once
+};
+
+// decodes the clips of file_names in waves : the files are mapped and their
+// headers checked on this thread, the frames of a wave are decoded on worker
+// threads with openmp when parallel, then the clips of the wave go to target
+// here before the next wave is decoded.
+// a wave holds the clips whose poses fit memory_budget bytes, or a single
+// clip bigger than that.
+MStatus readAnimations(const std::vector<std::string>& file_names, long long memory_budget,
+                       AnmBatchTarget& target, AnmBatchStats& stats, bool parallel = true);
+
+} // namespace riot
+
+#endif
@@ -0,0 +1,467 @@
+/*
+    Copyright 2011 Even Entem (alias ThiSpawn).
+
+    This file is part of Riot File Translator Plug-in for AutoDesk Maya.
+
+    Autodesk Maya's lib is under :
+    Copyright 1995, 2006, 2008 Autodesk, Inc. All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful, 
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <AnmBounds.h>
+
+#include <math.h>
+#include <string.h>
+
+#include <maya/MGlobal.h>
+
+#include <SknData.hpp>
+#include <SklData.hpp>
+#include <AnmData.hpp>
+#include <SklEvaluator.h>
+#include <BoneMatrices.h>
+#include <maya_misc.h>
+
+namespace riot {
+
+namespace {
+
+const int kBoundsVersion = 1;
+const int kFramesPerBatch = 64; // world matrices evaluated at once
+// magic, version, counts, fps, origin, radius step, position steps
+const int kHeaderSize = 56;
+const int kQuantizedSize = 10 * 2; // min, max, center, radius
+
+// the vertices of a mesh a bone influences, in bind pose
+struct Cluster
+{
+    int bone;
+    int mesh;
+    float center[3];
+    float extent[3]; // half size of the box
+    float radius; // from the center
+};
+
+void emptyVolume(BoundingVolume& volume)
+{
+    for (int c = 0; c < 3; c++)
+    {
+        volume.min[c] = 1e30f;
+        volume.max[c] = -1e30f;
+        volume.center[c] = 0.0f;
+    }
+    volume.radius = -1.0f;
+}
+
+bool isEmpty(const BoundingVolume& volume)
+{
+    return volume.radius < 0.0f;
+}
+
+// the box grows, the sphere is made once all the parts are in
+void addBox(BoundingVolume& volume, const float* center, const float* extent)
+{
+    for (int c = 0; c < 3; c++)
+    {
+        if (center[c] - extent[c] < volume.min[c])
+            volume.min[c] = center[c] - extent[c];
+        if (center[c] + extent[c] > volume.max[c])
+            volume.max[c] = center[c] + extent[c];
+    }
+    volume.radius = 0.0f;
+}
+
+struct Part
+{
+    float center[3];
+    float radius;
+};
+
+// the sphere around the center of the box which holds the parts
+void finishSphere(BoundingVolume& volume, const Part* parts, int num_parts)
+{
+    if (isEmpty(volume))
+    {
+        memset(&volume, 0, sizeof(volume));
+        return;
+    }
+    float radius = 0.0f;
+    for (int c = 0; c < 3; c++)
+        volume.center[c] = 0.5f * (volume.min[c] + volume.max[c]);
+    for (int k = 0; k < num_parts; k++)
+    {
+        float d[3];
+        for (int c = 0; c < 3; c++)
+            d[c] = parts[k].center[c] - volume.center[c];
+        float r = sqrtf(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]) + parts[k].radius;
+        if (r > radius)
+            radius = r;
+    }
+    volume.radius = radius;
+}
+
+void makeClusters(const SknData& mesh, const SklData& skeleton, int& num_meshes, std::vector<Cluster>& clusters)
+{
+    int num_bones = static_cast<int>(skeleton.bones.size());
+    int num_vertices = mesh.vertices.size();
+
+    // a mesh per material, all the vertices without materials
+    std::vector<int> first_vertex;
+    std::vector<int> end_vertex;
+    for (size_t m = 0; m < mesh.materials.size(); m++)
+    {
+        int first = mesh.materials[m].startVertex;
+        int end = first + mesh.materials[m].num_vertices;
+        first_vertex.push_back(first < 0 ? 0 : first);
+        end_vertex.push_back(end > num_vertices ? num_vertices : end);
+    }
+    if (first_vertex.empty())
+    {
+        first_vertex.push_back(0);
+        end_vertex.push_back(num_vertices);
+    }
+    num_meshes = static_cast<int>(first_vertex.size());
+
+    const float* positions = mesh.vertices.positions.data();
+    clusters.clear();
+    std::vector<int> cluster_of(num_bones);
+    for (int m = 0; m < num_meshes; m++)
+    {
+        // the boxes of the bones over the mesh, then the radii
+        std::vector<BoundingVolume> boxes(num_bones);
+        for (int b = 0; b < num_bones; b++)
+            emptyVolume(boxes[b]);
+        for (int pass = 0; pass < 2; pass++)
+        {
+            for (int i = first_vertex[m]; i < end_vertex[m]; i++)
+            {
+                const float* p = positions + 4 * i;
+                for (int j = 0; j < 4; j++)
+                {
+                    if (mesh.vertices.weights[4 * i + j] == 0.0f)
+                        continue;
+                    int n = mesh.vertices.skn_indices[4 * i + j];
+                    if (n >= skeleton.num_indices)
+                        continue;
+                    int b = skeleton.skn_indices[n];
+                    if (b < 0 || b >= num_bones)
+                        continue;
+                    BoundingVolume& box = boxes[b];
+                    if (pass == 0)
+                    {
+                        for (int c = 0; c < 3; c++)
+                        {
+                            if (p[c] < box.min[c])
+                                box.min[c] = p[c];
+                            if (p[c] > box.max[c])
+                                box.max[c] = p[c];
+                        }
+                        box.radius = 0.0f;
+                    }
+                    else
+                    {
+                        Cluster& cluster = clusters[cluster_of[b]];
+                        float d[3];
+                        for (int c = 0; c < 3; c++)
+                            d[c] = p[c] - cluster.center[c];
+                        float r = sqrtf(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+                        if (r > cluster.radius)
+                            cluster.radius = r;
+                    }
+                }
+            }
+            if (pass == 1)
+                break;
+            for (int b = 0; b < num_bones; b++)
+            {
+                if (isEmpty(boxes[b]))
+                    continue;
+                Cluster cluster;
+                cluster.bone = b;
+                cluster.mesh = m;
+                for (int c = 0; c < 3; c++)
+                {
+                    cluster.center[c] = 0.5f * (boxes[b].min[c] + boxes[b].max[c]);
+                    cluster.extent[c] = 0.5f * (boxes[b].max[c] - boxes[b].min[c]);
+                }
+                cluster.radius = 0.0f;
+                cluster_of[b] = static_cast<int>(clusters.size());
+                clusters.push_back(cluster);
+            }
+        }
+    }
+}
+
+// a box and a sphere moved by an affine matrix (maya layout)
+void moveCluster(const Cluster& cluster, const float* m, float* center, float* extent, float& radius)
+{
+    for (int c = 0; c < 3; c++)
+    {
+        center[c] = cluster.center[0] * m[c] + cluster.center[1] * m[4 + c] + cluster.center[2] * m[8 + c] + m[12 + c];
+        extent[c] = cluster.extent[0] * fabsf(m[c]) + cluster.extent[1] * fabsf(m[4 + c]) +
+                    cluster.extent[2] * fabsf(m[8 + c]);
+    }
+
+    // the sphere needs the largest stretch of the 3x3, the square root of
+    // the largest eigenvalue of its gram matrix, which is bounded by the
+    // largest row sum of that matrix : exact for a rotation with a uniform
+    // scale, above it with a skew or a non uniform scale
+    float scale2 = 0.0f;
+    for (int i = 0; i < 3; i++)
+    {
+        float sum = 0.0f;
+        for (int j = 0; j < 3; j++)
+            sum += fabsf(m[4 * i] * m[4 * j] + m[4 * i + 1] * m[4 * j + 1] + m[4 * i + 2] * m[4 * j + 2]);
+        if (sum > scale2)
+            scale2 = sum;
+    }
+    radius = cluster.radius * sqrtf(scale2);
+}
+
+void frameBounds(const SklEvaluator& evaluator, const std::vector<int>& parents, const float* worlds,
+                 const std::vector<Cluster>& clusters, int num_meshes, BoundingVolume* volumes)
+{
+    int num_bones = evaluator.numBones();
+    BoundingVolume* meshes = volumes;
+    BoundingVolume* bones = volumes + num_meshes;
+    for (int m = 0; m < num_meshes; m++)
+        emptyVolume(meshes[m]);
+    for (int b = 0; b < num_bones; b++)
+        emptyVolume(bones[b]);
+
+    std::vector<Part> mesh_parts;
+    std::vector<std::vector<Part> > bone_parts(num_bones);
+
+    if (clusters.empty())
+    {
+        // the joint and the parent's, a segment
+        const float zero[3] = { 0.0f, 0.0f, 0.0f };
+        for (int b = 0; b < num_bones; b++)
+        {
+            const float* joint = worlds + 16 * b + 12;
+            Part part = { { joint[0], joint[1], joint[2] }, 0.0f };
+            addBox(bones[b], joint, zero);
+            bone_parts[b].push_back(part);
+            if (parents[b] >= 0)
+            {
+                const float* parent = worlds + 16 * parents[b] + 12;
+                Part parent_part = { { parent[0], parent[1], parent[2] }, 0.0f };
+                addBox(bones[b], parent, zero);
+                bone_parts[b].push_back(parent_part);
+            }
+        }
+    }
+    else
+    {
+        std::vector<std::vector<Part> > parts_by_mesh(num_meshes);
+        for (size_t k = 0; k < clusters.size(); k++)
+        {
+            const Cluster& cluster = clusters[k];
+            float skinning[16];
+            multiplyMatrices(evaluator.inverseBindMatrix(cluster.bone), worlds + 16 * cluster.bone, skinning);
+            Part part;
+            float extent[3];
+            moveCluster(cluster, skinning, part.center, extent, part.radius);
+            addBox(meshes[cluster.mesh], part.center, extent);
+            addBox(bones[cluster.bone], part.center, extent);
+            parts_by_mesh[cluster.mesh].push_back(part);
+            bone_parts[cluster.bone].push_back(part);
+        }
+        for (int m = 0; m < num_meshes; m++)
+            finishSphere(meshes[m], parts_by_mesh[m].empty() ? 0 : &parts_by_mesh[m][0],
+                         static_cast<int>(parts_by_mesh[m].size()));
+    }
+
+    for (int b = 0; b < num_bones; b++)
+        finishSphere(bones[b], bone_parts[b].empty() ? 0 : &bone_parts[b][0], static_cast<int>(bone_parts[b].size()));
+}
+
+} // namespace
+
+MStatus computeBounds(const SklData& skeleton, const AnmData& animation, const SknData* mesh,
+                      AnmBounds& bounds, bool parallel)
+{
+    SklEvaluator evaluator;
+    if (evaluator.setSkeleton(skeleton) != MS::kSuccess)
+        return MS::kFailure;
+    if (evaluator.bindAnimation(animation) != MS::kSuccess)
+        return MS::kFailure;
+
+    int num_bones = evaluator.numBones();
+    int num_frames = animation.num_frames;
+    std::vector<int> parents(num_bones);
+    for (int b = 0; b < num_bones; b++)
+    {
+        int parent = skeleton.bones[b].parent;
+        parents[b] = parent == b ? -1 : parent;
+    }
+
+    int num_meshes = 0;
+    std::vector<Cluster> clusters;
+    if (mesh)
+        makeClusters(*mesh, skeleton, num_meshes, clusters);
+
+    bounds.num_frames = num_frames;
+    bounds.num_bones = num_bones;
+    bounds.num_meshes = num_meshes;
+    bounds.fps = animation.fps;
+    bounds.volumes.resize(static_cast<size_t>(num_frames) * (num_meshes + num_bones));
+
+    std::vector<float> worlds(static_cast<size_t>(kFramesPerBatch) * num_bones * 16 + 1);
+    for (int first = 0; first < num_frames; first += kFramesPerBatch)
+    {
+        int count = num_frames - first < kFramesPerBatch ? num_frames - first : kFramesPerBatch;
+        if (evaluator.evaluateFrames(animation, first, count, &worlds[0], parallel) != MS::kSuccess)
+            return MS::kFailure;
+
+#pragma omp parallel for schedule(dynamic) if(parallel)
+        for (int i = 0; i < count; i++)
+        {
+            frameBounds(evaluator, parents, &worlds[static_cast<size_t>(i) * num_bones * 16], clusters, num_meshes,
+                        &bounds.volumes[static_cast<size_t>(first + i) * (num_meshes + num_bones)]);
+        }
+    }
+
+    return MS::kSuccess;
+}
+
+MStatus writeBounds(const AnmBounds& bounds, ostream& file)
+{
+    // the box of the whole clip, the grid of the quantization
+    float origin[3] = { 0.0f, 0.0f, 0.0f };
+    float step[3] = { 1.0f, 1.0f, 1.0f };
+    size_t num_volumes = bounds.volumes.size();
+    if (num_volumes > 0)
+    {
+        float low[3], high[3];
+        for (int c = 0; c < 3; c++)
+        {
+            low[c] = 1e30f;
+            high[c] = -1e30f;
+        }
+        for (size_t k = 0; k < num_volumes; k++)
+        {
+            const BoundingVolume& volume = bounds.volumes[k];
+            for (int c = 0; c < 3; c++)
+            {
+                if (volume.min[c] < low[c])
+                    low[c] = volume.min[c];
+                if (volume.max[c] > high[c])
+                    high[c] = volume.max[c];
+            }
+        }
+        for (int c = 0; c < 3; c++)
+        {
+            origin[c] = low[c];
+            step[c] = (high[c] - low[c]) / 65534.0f;
+            if (!(step[c] > 0.0f))
+                step[c] = 1e-6f;
+        }
+    }
+    float radius_step = step[0] > step[1] ? step[0] : step[1];
+    radius_step = radius_step > step[2] ? radius_step : step[2];
+
+    char header[kHeaderSize];
+    memcpy(header, "r3d2bnds", 8);
+    memcpy(header + 8, &kBoundsVersion, 4);
+    memcpy(header + 12, &bounds.num_frames, 4);
+    memcpy(header + 16, &bounds.num_bones, 4);
+    memcpy(header + 20, &bounds.num_meshes, 4);
+    memcpy(header + 24, &bounds.fps, 4);
+    memcpy(header + 28, origin, 12);
+    memcpy(header + 40, &radius_step, 4);
+    memcpy(header + 44, step, 12);
+    file.write(header, sizeof(header));
+
+    std::vector<unsigned short> quantized(num_volumes * (kQuantizedSize / 2));
+    for (size_t k = 0; k < num_volumes; k++)
+    {
+        const BoundingVolume& volume = bounds.volumes[k];
+        unsigned short* q = &quantized[k * (kQuantizedSize / 2)];
+        // the center is rounded, the radius takes that error
+        float center_error = 0.0f;
+        for (int c = 0; c < 3; c++)
+        {
+            double low = floor((volume.min[c] - origin[c]) / step[c]);
+            double high = ceil((volume.max[c] - origin[c]) / step[c]);
+            double center = floor((volume.center[c] - origin[c]) / step[c] + 0.5);
+            q[c] = static_cast<unsigned short>(low < 0.0 ? 0.0 : (low > 65535.0 ? 65535.0 : low));
+            q[3 + c] = static_cast<unsigned short>(high < 0.0 ? 0.0 : (high > 65535.0 ? 65535.0 : high));
+            q[6 + c] = static_cast<unsigned short>(center < 0.0 ? 0.0 : (center > 65535.0 ? 65535.0 : center));
+            float error = fabsf(origin[c] + q[6 + c] * step[c] - volume.center[c]);
+            center_error += error * error;
+        }
+        double radius = ceil((volume.radius + sqrtf(center_error)) / radius_step);
+        q[9] = static_cast<unsigned short>(radius > 65535.0 ? 65535.0 : radius);
+    }
+    if (!quantized.empty())
+        file.write(reinterpret_cast<const char*>(&quantized[0]), quantized.size() * 2);
+
+    if (!file.good())
+        FAILURE("writeBounds: the file could not be written");
+    return MS::kSuccess;
+}
+
+MStatus readBounds(istream& file, AnmBounds& bounds)
+{
+    char header[kHeaderSize];
+    file.read(header, sizeof(header));
+    if (file.gcount() != static_cast<std::streamsize>(sizeof(header)))
+        FAILURE("readBounds: the file is too short");
+    if (strncmp(header, "r3d2bnds", 8))
+        FAILURE("readBounds: magic is wrong!");
+    int version;
+    memcpy(&version, header + 8, 4);
+    if (version != kBoundsVersion)
+        FAILURE("readBounds: version not supported");
+
+    memcpy(&bounds.num_frames, header + 12, 4);
+    memcpy(&bounds.num_bones, header + 16, 4);
+    memcpy(&bounds.num_meshes, header + 20, 4);
+    memcpy(&bounds.fps, header + 24, 4);
+    float origin[3], step[3], radius_step;
+    memcpy(origin, header + 28, 12);
+    memcpy(&radius_step, header + 40, 4);
+    memcpy(step, header + 44, 12);
+    if (bounds.num_frames < 0 || bounds.num_bones < 0 || bounds.num_meshes < 0 ||
+        (bounds.num_frames > 0 && bounds.num_bones + bounds.num_meshes > (1 << 24) / bounds.num_frames))
+        FAILURE("readBounds: bad counts");
+
+    size_t num_volumes = static_cast<size_t>(bounds.num_frames) * (bounds.num_bones + bounds.num_meshes);
+    std::vector<unsigned short> quantized(num_volumes * (kQuantizedSize / 2));
+    if (!quantized.empty())
+    {
+        file.read(reinterpret_cast<char*>(&quantized[0]), quantized.size() * 2);
+        if (file.gcount() != static_cast<std::streamsize>(quantized.size() * 2))
+            FAILURE("readBounds: unexpected end of file");
+    }
+
+    bounds.volumes.resize(num_volumes);
+    for (size_t k = 0; k < num_volumes; k++)
+    {
+        const unsigned short* q = &quantized[k * (kQuantizedSize / 2)];
+        BoundingVolume& volume = bounds.volumes[k];
+        for (int c = 0; c < 3; c++)
+        {
+            volume.min[c] = origin[c] + q[c] * step[c];
+            volume.max[c] = origin[c] + q[3 + c] * step[c];
+            volume.center[c] = origin[c] + q[6 + c] * step[c];
+        }
+        volume.radius = q[9] * radius_step;
+    }
+
+    return MS::kSuccess;
+}
+
+} // namespace riot
@@ -0,0 +1,85 @@
+/*
+    Copyright 2011 Even Entem (alias ThiSpawn).
+
+    This file is part of Riot File Translator Plug-in for AutoDesk Maya.
+
+    Autodesk Maya's lib is under :
+    Copyright 1995, 2006, 2008 Autodesk, Inc. All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful, 
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef RIOT__ANMBOUNDS_H
+#define RIOT__ANMBOUNDS_H
+
+#include <vector>
+
+#include <maya/MStatus.h>
+#include <maya/MIOStream.h>
+
+namespace riot {
+
+class SknData;
+struct SklData;
+struct AnmData;
+
+// a box and a sphere around the same points
+struct BoundingVolume
+{
+    float min[3];
+    float max[3];
+    float center[3];
+    float radius;
+};
+
+// the bounds of every bone and every mesh (the materials of a skn) at
+// every frame of a clip, frame after frame : the meshes of a frame, then
+// its bones.
+struct AnmBounds
+{
+    AnmBounds() : num_frames(0), num_bones(0), num_meshes(0), fps(0.0f) {}
+
+    const BoundingVolume& mesh(int frame, int mesh_index) const
+    {
+        return volumes[frame * (num_meshes + num_bones) + mesh_index];
+    }
+    const BoundingVolume& bone(int frame, int bone_index) const
+    {
+        return volumes[frame * (num_meshes + num_bones) + num_meshes + bone_index];
+    }
+
+    int num_frames;
+    int num_bones; // of the skeleton
+    int num_meshes;
+    float fps;
+    std::vector<BoundingVolume> volumes;
+};
+
+// the bounds of animation played on skeleton.
+// with a mesh, the vertices each bone influences are bounded once in bind
+// pose, per material, and those volumes are moved by the bone at each
+// frame. a skinned vertex being a blend of its bones' moves, it stays in
+// the union of their volumes, so the bounds hold without skinning. without
+// a mesh, a bone is bounded by its joint and its parent's.
+// the frames are split between threads with openmp when parallel.
+MStatus computeBounds(const SklData& skeleton, const AnmData& animation, const SknData* mesh,
+                      AnmBounds& bounds, bool parallel = true);
+
+// a compact sidecar : the volumes are quantized on 16 bits in the box of
+// the whole clip, rounded outwards so they still hold
+MStatus writeBounds(const AnmBounds& bounds, ostream& file);
+MStatus readBounds(istream& file, AnmBounds& bounds);
+
+} // namespace riot
+
+#endif
@@ -0,0 +1,172 @@
+/*
+    Copyright 2011 Even Entem (alias ThiSpawn).
+
+    This file is part of Riot File Translator Plug-in for AutoDesk Maya.
+
+    Autodesk Maya's lib is under :
+    Copyright 1995, 2006, 2008 Autodesk, Inc. All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful, 
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <AnmCurves.h>
+
+#include <maya/MGlobal.h>
+#include <maya/MFnIkJoint.h>
+#include <maya/MFnAnimCurve.h>
+#include <maya/MFnDependencyNode.h>
+#include <maya/MPlugArray.h>
+#include <maya/MDGContext.h>
+#include <maya/MTime.h>
+#include <maya/MTimeArray.h>
+#include <maya/MDoubleArray.h>
+#include <maya/MQuaternion.h>
+
+#include <maya_misc.h>
+
+namespace riot {
+
+namespace {
+
+const char* const kChannelNames[AnmCurveSource::kNumChannels] = {
+    "translateX", "translateY", "translateZ",
+    "rotateX", "rotateY", "rotateZ"
+};
+
+// the anim curve driving plug, or a null object
+MObject findCurve(const MPlug& plug)
+{
+    MPlugArray sources;
+    plug.connectedTo(sources, true, false);
+    if (sources.length() == 1 && sources[0].node().hasFn(MFn::kAnimCurve))
+        return sources[0].node();
+    return MObject::kNullObj;
+}
+
+} // namespace
+
+MayaCurveSource::MayaCurveSource(const MDagPathArray& joints, bool with_orientation)
+    : joints_(joints), with_orientation_(with_orientation)
+{
+    int num_joints = joints_.length();
+    plugs_.resize(num_joints * kNumChannels);
+    curves_.resize(num_joints * kNumChannels);
+    for (int j = 0; j < num_joints; j++)
+    {
+        MFnDependencyNode fn_node(joints_[j].node());
+        for (int c = 0; c < kNumChannels; c++)
+        {
+            MPlug plug = fn_node.findPlug(kChannelNames[c]);
+            plugs_[j * kNumChannels + c] = plug;
+            curves_[j * kNumChannels + c] = findCurve(plug);
+        }
+    }
+}
+
+int MayaCurveSource::numJoints() const
+{
+    return joints_.length();
+}
+
+void MayaCurveSource::getSetup(int joint, AnmJointSetup& setup) const
+{
+    MFnIkJoint fn_joint(joints_[joint]);
+    MQuaternion axe, orient;
+    if (with_orientation_)
+    {
+        axe = fn_joint.rotateOrientation(MSpace::kTransform);
+        fn_joint.getOrientation(orient);
+    }
+    setup.rotate_axis[0] = static_cast<float>(axe.x);
+    setup.rotate_axis[1] = static_cast<float>(axe.y);
+    setup.rotate_axis[2] = static_cast<float>(axe.z);
+    setup.rotate_axis[3] = static_cast<float>(axe.w);
+    setup.joint_orient[0] = static_cast<float>(orient.x);
+    setup.joint_orient[1] = static_cast<float>(orient.y);
+    setup.joint_orient[2] = static_cast<float>(orient.z);
+    setup.joint_orient[3] = static_cast<float>(orient.w);
+    setup.rotate_order = fn_joint.findPlug("rotateOrder").asShort();
+}
+
+void MayaCurveSource::evaluate(int joint, const double* times, int num_times, double* values)
+{
+    for (int c = 0; c < kNumChannels; c++)
+    {
+        const MPlug& plug = plugs_[joint * kNumChannels + c];
+        const MObject& curve = curves_[joint * kNumChannels + c];
+        if (!curve.isNull())
+        {
+            MFnAnimCurve fn_curve(curve);
+            for (int i = 0; i < num_times; i++)
+                fn_curve.evaluate(MTime(times[i], MTime::uiUnit()), values[i * kNumChannels + c]);
+        }
+        else
+        {
+            // constraints, expressions, or nothing plugged
+            for (int i = 0; i < num_times; i++)
+            {
+                MDGContext context(MTime(times[i], MTime::uiUnit()));
+                plug.getValue(values[i * kNumChannels + c], context);
+            }
+        }
+    }
+}
+
+MStatus keyChannels(const MDagPathArray& joints, const double* values, double start_time, int num_frames)
+{
+    const int kNumChannels = AnmCurveSource::kNumChannels;
+
+    MTimeArray times;
+    times.setLength(num_frames);
+    for (int i = 0; i < num_frames; i++)
+        times[i] = MTime(start_time + i, MTime::uiUnit());
+
+    MStatus status;
+    MFnAnimCurve fn_curve;
+    MDoubleArray curve_values(num_frames);
+    int num_joints = joints.length();
+    for (int j = 0; j < num_joints; j++)
+    {
+        MFnDependencyNode fn_node(joints[j].node());
+        const double* joint_values = values + static_cast<size_t>(j) * num_frames * kNumChannels;
+        for (int c = 0; c < kNumChannels; c++)
+        {
+            MPlug plug = fn_node.findPlug(kChannelNames[c]);
+            MObject curve = findCurve(plug);
+            if (!curve.isNull())
+            {
+                fn_curve.setObject(curve);
+            }
+            else
+            {
+                // the type of curve (linear, angular) follows the plug
+                fn_curve.create(plug, NULL, &status);
+                if (status != MS::kSuccess)
+                {
+                    MGlobal::displayWarning("keyChannels: " + plug.name() + " can't be keyed, it is locked or driven");
+                    continue;
+                }
+            }
+
+            for (int i = 0; i < num_frames; i++)
+                curve_values[i] = joint_values[i * kNumChannels + c];
+            if (fn_curve.addKeys(&times, &curve_values, MFnAnimCurve::kTangentGlobal,
+                                 MFnAnimCurve::kTangentGlobal, true) != MS::kSuccess)
+                FAILURE("keyChannels: MFnAnimCurve::addKeys() on " + plug.name());
+        }
+    }
+
+    return MS::kSuccess;
+}
+
+} // namespace riot
@@ -0,0 +1,66 @@
+/*
+    Copyright 2011 Even Entem (alias ThiSpawn).
+
+    This file is part of Riot File Translator Plug-in for AutoDesk Maya.
+
+    Autodesk Maya's lib is under :
+    Copyright 1995, 2006, 2008 Autodesk, Inc. All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful, 
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef RIOT__ANMCURVES_H
+#define RIOT__ANMCURVES_H
+
+#include <vector>
+
+#include <maya/MStatus.h>
+#include <maya/MDagPathArray.h>
+#include <maya/MPlug.h>
+#include <maya/MObject.h>
+
+#include <AnmSampler.h>
+
+namespace riot {
+
+// the joint channels, read from their anim curve when they have one,
+// else evaluated through the dependency graph at the asked time.
+// none of it is thread safe, so the sampler calls it from this thread only.
+class MayaCurveSource : public AnmCurveSource
+{
+public:
+    // without the orientation, the setups have no rotate axis nor joint
+    // orient and the sampled rotations are the rotate attributes alone
+    explicit MayaCurveSource(const MDagPathArray& joints, bool with_orientation = true);
+
+    int numJoints() const;
+    void getSetup(int joint, AnmJointSetup& setup) const;
+    void evaluate(int joint, const double* times, int num_times, double* values);
+    bool isThreadSafe() const { return false; }
+
+private:
+    const MDagPathArray& joints_;
+    bool with_orientation_;
+    std::vector<MPlug> plugs_;
+    std::vector<MObject> curves_;
+};
+
+// keys the channels of the joints, laid out as extractChannels() gives
+// them, at the num_frames frames from start_time : one addKeys per curve.
+// the curves are created where there are none, the existing keys out of
+// the frames are kept.
+MStatus keyChannels(const MDagPathArray& joints, const double* values, double start_time, int num_frames);
+
+} // namespace riot
+
+#endif
@@ -22,10 +22,13 @@
 #ifndef RIOT__ANMDATA_HPP
 #define RIOT__ANMDATA_HPP
 
+#include <algorithm>
 #include <vector>
 
 #include <maya/MDagPathArray.h>
-#include <maya/MTransformationMatrix.h>
+
+#include <Handedness.hpp>
+#include <AnmPoses.hpp>
 
 namespace riot {
 
@@ -57,7 +60,7 @@ struct AnmBone
     static const int kNameLen = 0x20;
 
     AnmBone()
-        : name_hash(0)
+        : flag(0), name_hash(0)
     {
         memset(name, 0, kNameLen);
     }
@@ -68,10 +71,107 @@ struct AnmBone
     std::vector<AnmPos> poses;
 };
 
+// the poses are either in each bone (bones[i].poses) or, packed, all in
+// pose_buffer, frame after frame. the bones keep their names and flags.
 struct AnmData
 {
+    bool packed() const { return !pose_buffer.empty(); }
+
+    // moves the poses from the bones to pose_buffer
+    void packPoses()
+    {
+        if (packed())
+            return;
+        int bones_size = static_cast<int>(bones.size());
+        pose_buffer.resize(num_frames, bones_size);
+        for (int i = 0; i < bones_size; i++)
+        {
+            AnmPoseView<float> view = pose_buffer.bone(i);
+            std::vector<AnmPos>& poses = bones[i].poses;
+            int count = static_cast<int>(poses.size()) < num_frames ? static_cast<int>(poses.size()) : num_frames;
+            for (int j = 0; j < count; j++)
+                view.set(j, poses[j]);
+            std::vector<AnmPos>().swap(poses);
+        }
+    }
+
+    // moves the poses from pose_buffer back to the bones
+    void unpackPoses()
+    {
+        if (!packed())
+            return;
+        int bones_size = static_cast<int>(bones.size());
+        for (int i = 0; i < bones_size; i++)
+        {
+            AnmPoseView<const float> view = static_cast<const AnmPoseBuffer&>(pose_buffer).bone(i);
+            std::vector<AnmPos>& poses = bones[i].poses;
+            poses.resize(view.count);
+            for (int j = 0; j < view.count; j++)
+                view.get(j, poses[j]);
+        }
+        pose_buffer.clear();
+    }
+
+    // from whichever holds the poses
+    void getPose(int bone, int frame, AnmPos& pos) const
+    {
+        if (packed())
+            pose_buffer.frame(frame).get(bone, pos);
+        else
+            pos = bones[bone].poses[frame];
+    }
+
+    // to whichever holds the poses
+    void setPose(int bone, int frame, const AnmPos& pos)
+    {
+        if (packed())
+            pose_buffer.frame(frame).set(bone, pos);
+        else
+            bones[bone].poses[frame] = pos;
+    }
+
+    // drops the bones whose keep[bone] is 0, from the bones and from
+    // whichever holds the poses
+    void keepBones(const std::vector<char>& keep)
+    {
+        if (packed() && !keep.empty())
+            pose_buffer.keepBones(&keep[0]);
+        int kept = 0;
+        for (size_t i = 0; i < bones.size(); i++)
+        {
+            if (!keep[i])
+                continue;
+            if (kept != static_cast<int>(i))
+                std::swap(bones[kept], bones[i]);
+            kept++;
+        }
+        bones.resize(kept);
+        num_bones = kept;
+    }
+
     void switchHand()
     {
+        if (packed())
+        {
+            int size = pose_buffer.numFrames() * pose_buffer.numBones();
+            float* rot[4] = {
+                pose_buffer.plane(kPlaneRotX), pose_buffer.plane(kPlaneRotY),
+                pose_buffer.plane(kPlaneRotZ), pose_buffer.plane(kPlaneRotW)
+            };
+            float* x = pose_buffer.plane(kPlanePosX);
+            float* y = pose_buffer.plane(kPlanePosY);
+            float* z = pose_buffer.plane(kPlanePosZ);
+            for (int i = 0; i < size; i++)
+            {
+                float q[4] = { rot[0][i], rot[1][i], rot[2][i], rot[3][i] };
+                SwitchHand::quaternion(q);
+                for (int c = 0; c < 4; c++)
+                    rot[c][i] = q[c];
+                SwitchHand::position(x[i], y[i], z[i]);
+            }
+            return;
+        }
+
         int bones_size = static_cast<int>(bones.size());
         for (int i = 0; i < bones_size; i++)
         {
@@ -79,9 +179,8 @@ struct AnmData
             for (int j = 0; j < num_frames; j++)
             {
                 AnmPos& pos = bone.poses.at(j);
-                pos.rot[1] = -pos.rot[1];
-                pos.rot[2] = -pos.rot[2];
-                pos.x = -pos.x;
+                SwitchHand::quaternion(pos.rot);
+                SwitchHand::position(pos.x, pos.y, pos.z);
             }
         }
     }
@@ -91,6 +190,7 @@ struct AnmData
     int num_frames;
     float fps;
     std::vector<AnmBone> bones;
+    AnmPoseBuffer pose_buffer;
     MDagPathArray joints;
 };
 
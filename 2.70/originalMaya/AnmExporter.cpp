@@ -24,6 +24,7 @@
 
 #include <maya/MStatus.h>
 #include <maya/MString.h>
+#include <maya/MStringArray.h>
 #include <maya/MGlobal.h>
 #include <maya/MIOStream.h>
 #include <maya/MFStream.h>
@@ -31,6 +32,7 @@
 #include <maya_misc.h>
 
 #include <AnmWriter.h>
+#include <AnmKeyReduction.h>
 
 namespace riot {
 
@@ -40,7 +42,7 @@ void* AnmExporter::creator()
 }
 
 MStatus AnmExporter::writer(const MFileObject& file, 
-                         const MString& /*options*/, 
+                         const MString& options, 
                          MPxFileTranslator::FileAccessMode mode) 
 {
     if (MPxFileTranslator::kExportAccessMode != mode)
@@ -60,6 +62,43 @@ MStatus AnmExporter::writer(const MFileObject& file,
         const MString file_name = file.fullName();
     #endif
 
+    MStringArray option_list;
+    MStringArray the_option;
+    options.split(';', option_list);
+
+    // version 4 : pooled and deduplicated keys, smaller and faster to load
+    int version = 3;
+    float tolerance = 0.0f;
+    // keyframe reduction, in degrees and scene units, off when both are 0
+    float reduce_angle = 0.0f;
+    float reduce_position = 0.0f;
+
+    int num_options = static_cast<int>(option_list.length());
+    for (int i = 0; i < num_options; i++)
+    {
+        the_option.clear();
+        option_list[i].split('=', the_option);
+        if (the_option.length() < 1)
+            continue;
+
+        if (the_option[0] == "version" && the_option.length() > 1)
+        {
+            version = (the_option[1].asUnsigned() == 4) ? 4 : 3;
+        }
+        else if (the_option[0] == "tolerance" && the_option.length() > 1)
+        {
+            tolerance = the_option[1].asFloat();
+        }
+        else if (the_option[0] == "reduceAngle" && the_option.length() > 1)
+        {
+            reduce_angle = the_option[1].asFloat();
+        }
+        else if (the_option[0] == "reducePosition" && the_option.length() > 1)
+        {
+            reduce_position = the_option[1].asFloat();
+        }
+    }
+
     ofstream fout(file_name.asChar(), ios::binary);
 
     if (!fout)
@@ -72,6 +111,31 @@ MStatus AnmExporter::writer(const MFileObject& file,
         delete writer;
         FAILURE("AnmExporter: writer->dumpData(): failed");
     }
+    writer->data_.version = version;
+
+    if (reduce_angle > 0.0f || reduce_position > 0.0f)
+    {
+        std::vector<AnmTolerance> tolerances(1, AnmTolerance(reduce_angle * 3.14159265f / 180.0f, reduce_position));
+        std::vector<AnmBoneKeys> keys;
+        AnmReductionReport report;
+        if (MStatus::kFailure == reduceKeys(writer->data_, tolerances, keys, report))
+        {
+            delete writer;
+            FAILURE("AnmExporter: reduceKeys(): failed");
+        }
+        if (MStatus::kFailure == applyKeys(keys, writer->data_))
+    {
+        delete writer;
+        FAILURE("AnmExporter: applyKeys(): failed");
+    }
+        MGlobal::displayInfo(MString("AnmExporter: kept ") + static_cast<int>(report.num_rotation_keys) +
+                             " rotation and " + static_cast<int>(report.num_position_keys) + " position keys of " +
+                             static_cast<int>(report.num_frames) + ", " + report.num_static_bones +
+                             " static bones, max error " + report.max_angle_error * 180.0f / 3.14159265f +
+                             " degrees / " + report.max_position_error);
+    }
+
+    writer->tolerance_ = tolerance;
     if (MStatus::kFailure == writer->write(fout))
     {
         delete writer;
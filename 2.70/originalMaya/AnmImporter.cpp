@@ -27,10 +27,12 @@
 #include <maya/MGlobal.h>
 #include <maya/MIOStream.h>
 #include <maya/MFStream.h>
+#include <maya/MStringArray.h>
 
 #include <maya_misc.h>
 
 #include <AnmReader.h>
+#include <AssetCache.h>
 
 namespace riot {
 
@@ -40,7 +42,7 @@ void* AnmImporter::creator()
 }
 
 MStatus AnmImporter::reader(const MFileObject& file, 
-                         const MString& /*options*/, 
+                         const MString& options, 
                          MPxFileTranslator::FileAccessMode mode) 
 {
     if (MPxFileTranslator::kImportAccessMode != mode)
@@ -60,25 +62,70 @@ MStatus AnmImporter::reader(const MFileObject& file,
         const MString file_name = file.fullName();
     #endif
 
-    ifstream fin(file_name.asChar(), ios::binary);
+    MStringArray option_list;
+    MStringArray the_option;
+    options.split(';', option_list);
 
-    if (!fin)
-        FAILURE("AnmImporter: " + file_name + " : could not be opened for reading");
+    // a window of the clip, only these frames are decoded
+    int start_frame = 0;
+    int num_frames = 0; // 0 : the whole clip
+
+    int num_options = static_cast<int>(option_list.length());
+    for (int i = 0; i < num_options; i++)
+    {
+        the_option.clear();
+        option_list[i].split('=', the_option);
+        if (the_option.length() < 2)
+            continue;
+
+        if (the_option[0] == "startFrame")
+            start_frame = the_option[1].asUnsigned();
+        else if (the_option[0] == "numFrames")
+            num_frames = the_option[1].asUnsigned();
+    }
 
     AnmReader *reader = new AnmReader();
 
-    if (MStatus::kFailure == reader->read(fin))
+    if (num_frames > 0)
     {
-        delete reader;
-        FAILURE("AnmImporter: reader->read(" + file_name + "); failed");
+        if (MStatus::kFailure == reader->open(file_name.asChar()))
+        {
+            delete reader;
+            FAILURE("AnmImporter: reader->open(" + file_name + "); failed");
+        }
+        if (start_frame >= reader->clipFrames())
+            start_frame = reader->clipFrames() > 0 ? reader->clipFrames() - 1 : 0;
+        if (num_frames > reader->clipFrames() - start_frame)
+            num_frames = reader->clipFrames() - start_frame;
+        if (MStatus::kFailure == reader->readFrames(start_frame, num_frames))
+        {
+            delete reader;
+            FAILURE("AnmImporter: reader->readFrames(): failed");
+        }
     }
+    else
+    {
+        ifstream fin(file_name.asChar(), ios::binary);
+
+        if (!fin)
+        {
+            delete reader;
+            FAILURE("AnmImporter: " + file_name + " : could not be opened for reading");
+        }
+
+        if (MStatus::kFailure == AssetCache::importCache().read(*reader, fin, file_name.asChar()))
+        {
+            delete reader;
+            FAILURE("AnmImporter: reader->read(" + file_name + "); failed");
+        }
+    }
+
     if (MStatus::kFailure == reader->loadData())
     {
         delete reader;
         FAILURE("AnmImporter: reader->loadData(): failed");
     }
 
-    fin.close();
     delete reader;
 
     MGlobal::displayInfo("AnmImporter: import from " + file_name + " successful!");
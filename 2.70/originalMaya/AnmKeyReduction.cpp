@@ -0,0 +1,392 @@
+/*
+    Copyright 2011 Even Entem (alias ThiSpawn).
+
+    This file is part of Riot File Translator Plug-in for AutoDesk Maya.
+
+    Autodesk Maya's lib is under :
+    Copyright 1995, 2006, 2008 Autodesk, Inc. All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful, 
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <AnmKeyReduction.h>
+
+#include <math.h>
+#include <string.h>
+
+#include <maya/MGlobal.h>
+
+#include <AnmData.hpp>
+#include <maya_misc.h>
+
+namespace riot {
+
+namespace {
+
+// distance of two unit quaternions, whatever their sign. for a rotation of
+// angle a between them, it is 2 sin(a / 4).
+double chord(const double* a, const double* b)
+{
+    double minus = 0.0;
+    double plus = 0.0;
+    for (int c = 0; c < 4; c++)
+    {
+        minus += (a[c] - b[c]) * (a[c] - b[c]);
+        plus += (a[c] + b[c]) * (a[c] + b[c]);
+    }
+    return sqrt(minus < plus ? minus : plus);
+}
+
+double chordToAngle(double chord)
+{
+    double half = chord * 0.5 < 1.0 ? chord * 0.5 : 1.0;
+    return 4.0 * asin(half);
+}
+
+void slerp(const double* a, const double* b, double t, double* q)
+{
+    double dot = a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3];
+    double sign = dot < 0.0 ? -1.0 : 1.0;
+    dot *= sign;
+
+    double w0 = 1.0 - t;
+    double w1 = t;
+    if (dot < 0.9999)
+    {
+        double angle = acos(dot);
+        double inv_sin = 1.0 / sin(angle);
+        w0 = sin((1.0 - t) * angle) * inv_sin;
+        w1 = sin(t * angle) * inv_sin;
+    }
+    w1 *= sign;
+
+    double length = 0.0;
+    for (int c = 0; c < 4; c++)
+    {
+        q[c] = w0 * a[c] + w1 * b[c];
+        length += q[c] * q[c];
+    }
+    double scale = length > 0.0 ? 1.0 / sqrt(length) : 0.0;
+    for (int c = 0; c < 4; c++)
+        q[c] *= scale;
+}
+
+// the channel of a bone, N values per frame
+template <int N>
+struct Channel
+{
+    const double* values;
+    int num_frames;
+
+    const double* at(int frame) const { return values + frame * N; }
+};
+
+double distance(const Channel<4>& /*channel*/, const double* a, const double* b)
+{
+    return chord(a, b);
+}
+
+double distance(const Channel<3>& /*channel*/, const double* a, const double* b)
+{
+    double d0 = a[0] - b[0];
+    double d1 = a[1] - b[1];
+    double d2 = a[2] - b[2];
+    return sqrt(d0 * d0 + d1 * d1 + d2 * d2);
+}
+
+void interpolate(const Channel<4>& /*channel*/, const double* a, const double* b, double t, double* value)
+{
+    slerp(a, b, t, value);
+}
+
+void interpolate(const Channel<3>& /*channel*/, const double* a, const double* b, double t, double* value)
+{
+    for (int c = 0; c < 3; c++)
+        value[c] = a[c] + t * (b[c] - a[c]);
+}
+
+// the frames between first and last are rebuilt within tolerance from the
+// values a and b of those keys
+template <int N>
+bool fits(const Channel<N>& channel, const double* a, int first, const double* b, int last, double tolerance)
+{
+    double value[N];
+    for (int i = first + 1; i < last; i++)
+    {
+        interpolate(channel, a, b, static_cast<double>(i - first) / (last - first), value);
+        if (distance(channel, value, channel.at(i)) > tolerance)
+            return false;
+    }
+    return true;
+}
+
+// the farthest frame that the values from a key frame to it are within
+// tolerance of a line (slerp / lerp). the frame is found by doubling the
+// segment then by bisection, so a long run costs n log n.
+template <int N>
+int farthestLine(const Channel<N>& channel, const double* a, int first, double tolerance)
+{
+    int last_frame = channel.num_frames - 1;
+    int good = first + 1;
+    int bad = -1;
+    for (int length = 2; bad < 0; length *= 2)
+    {
+        int candidate = first + length < last_frame ? first + length : last_frame;
+        if (!fits(channel, a, first, channel.at(candidate), candidate, tolerance))
+            bad = candidate;
+        else if (candidate == last_frame)
+            return last_frame;
+        else
+            good = candidate;
+    }
+    while (bad - good > 1)
+    {
+        int middle = good + (bad - good) / 2;
+        if (fits(channel, a, first, channel.at(middle), middle, tolerance))
+            good = middle;
+        else
+            bad = middle;
+    }
+    return good;
+}
+
+// the key frames, greedily : from a key, the farthest next key that keeps
+// the frames between within tolerance. a key holding the value of the one
+// before is preferred when it goes as far, the version 4 pools then store
+// it once. sources are the frames the values of the keys are taken from.
+template <int N>
+void findKeys(const Channel<N>& channel, double tolerance, std::vector<int>& frames, std::vector<int>& sources)
+{
+    frames.clear();
+    sources.clear();
+    int last_frame = channel.num_frames - 1;
+    int key = 0;
+    int source = 0;
+    frames.push_back(0);
+    sources.push_back(0);
+    while (key < last_frame)
+    {
+        const double* a = channel.at(source);
+        int hold = key;
+        while (hold < last_frame && distance(channel, a, channel.at(hold + 1)) <= tolerance)
+            hold++;
+        int line = farthestLine(channel, a, key, tolerance);
+        if (hold > key && hold >= line)
+        {
+            key = hold;
+        }
+        else
+        {
+            key = line;
+            source = line;
+        }
+        frames.push_back(key);
+        sources.push_back(source);
+    }
+}
+
+// the largest error of the rebuilt channel against the sampled one
+template <int N>
+double maxError(const Channel<N>& channel, const std::vector<int>& frames, const std::vector<int>& sources)
+{
+    double error = 0.0;
+    double value[N];
+    for (size_t k = 0; k < frames.size(); k++)
+    {
+        const double* a = channel.at(sources[k]);
+        double e = distance(channel, a, channel.at(frames[k]));
+        if (e > error)
+            error = e;
+        if (k + 1 == frames.size())
+            break;
+        const double* b = channel.at(sources[k + 1]);
+        for (int i = frames[k] + 1; i < frames[k + 1]; i++)
+        {
+            interpolate(channel, a, b, static_cast<double>(i - frames[k]) / (frames[k + 1] - frames[k]), value);
+            e = distance(channel, value, channel.at(i));
+            if (e > error)
+                error = e;
+        }
+    }
+    return error;
+}
+
+void reduceBone(const AnmData& data, int bone, const AnmTolerance& tolerance, AnmBoneKeys& keys)
+{
+    int num_frames = data.num_frames;
+    std::vector<double> rotations(num_frames * 4);
+    std::vector<double> positions(num_frames * 3);
+    for (int i = 0; i < num_frames; i++)
+    {
+        AnmPos pos;
+        data.getPose(bone, i, pos);
+        double length = 0.0;
+        for (int c = 0; c < 4; c++)
+            length += static_cast<double>(pos.rot[c]) * pos.rot[c];
+        double scale = length > 0.0 ? 1.0 / sqrt(length) : 0.0;
+        for (int c = 0; c < 4; c++)
+            rotations[i * 4 + c] = pos.rot[c] * scale;
+        positions[i * 3 + 0] = pos.x;
+        positions[i * 3 + 1] = pos.y;
+        positions[i * 3 + 2] = pos.z;
+    }
+
+    Channel<4> rotation_channel = { &rotations[0], num_frames };
+    Channel<3> position_channel = { &positions[0], num_frames };
+    std::vector<int> rotation_sources;
+    std::vector<int> position_sources;
+    findKeys(rotation_channel, 2.0 * sin(tolerance.angle * 0.25), keys.rotation_frames, rotation_sources);
+    findKeys(position_channel, tolerance.position, keys.position_frames, position_sources);
+
+    // the keys keep the values as sampled, not normalized
+    keys.rotations.resize(rotation_sources.size() * 4);
+    for (size_t k = 0; k < rotation_sources.size(); k++)
+    {
+        AnmPos pos;
+        data.getPose(bone, rotation_sources[k], pos);
+        memcpy(&keys.rotations[k * 4], pos.rot, 4 * sizeof(float));
+    }
+    keys.positions.resize(position_sources.size() * 3);
+    for (size_t k = 0; k < position_sources.size(); k++)
+    {
+        AnmPos pos;
+        data.getPose(bone, position_sources[k], pos);
+        keys.positions[k * 3 + 0] = pos.x;
+        keys.positions[k * 3 + 1] = pos.y;
+        keys.positions[k * 3 + 2] = pos.z;
+    }
+
+    keys.max_angle_error = static_cast<float>(
+        chordToAngle(maxError(rotation_channel, keys.rotation_frames, rotation_sources)));
+    keys.max_position_error = static_cast<float>(maxError(position_channel, keys.position_frames, position_sources));
+}
+
+} // namespace
+
+MStatus reduceKeys(const AnmData& data, const std::vector<AnmTolerance>& tolerances,
+                   std::vector<AnmBoneKeys>& keys, AnmReductionReport& report, bool parallel)
+{
+    int num_bones = data.num_bones;
+    if (num_bones < 0 || static_cast<int>(data.bones.size()) < num_bones)
+        FAILURE("reduceKeys: the counts don't match the data");
+    if (tolerances.size() != 1 && static_cast<int>(tolerances.size()) != num_bones)
+        FAILURE("reduceKeys: one tolerance, or one per bone");
+    if (data.num_frames < 1)
+        FAILURE("reduceKeys: no frame");
+
+    keys.clear();
+    keys.resize(num_bones);
+
+#pragma omp parallel for schedule(dynamic) if(parallel)
+    for (int j = 0; j < num_bones; j++)
+        reduceBone(data, j, tolerances.size() == 1 ? tolerances[0] : tolerances[j], keys[j]);
+
+    report = AnmReductionReport();
+    report.num_frames = static_cast<long long>(data.num_frames) * num_bones;
+    for (int j = 0; j < num_bones; j++)
+    {
+        const AnmBoneKeys& bone_keys = keys[j];
+        report.num_rotation_keys += bone_keys.rotation_frames.size();
+        report.num_position_keys += bone_keys.position_frames.size();
+        if (bone_keys.rotation_frames.size() <= 2 && bone_keys.position_frames.size() <= 2)
+            report.num_static_bones++;
+        if (bone_keys.max_angle_error > report.max_angle_error)
+            report.max_angle_error = bone_keys.max_angle_error;
+        if (bone_keys.max_position_error > report.max_position_error)
+            report.max_position_error = bone_keys.max_position_error;
+    }
+
+    return MS::kSuccess;
+}
+
+MStatus applyKeys(const std::vector<AnmBoneKeys>& keys, AnmData& data, bool parallel)
+{
+    int num_bones = static_cast<int>(keys.size());
+    if (num_bones != data.num_bones)
+        FAILURE("applyKeys: the keys are not the ones of these bones");
+
+#pragma omp parallel for schedule(dynamic) if(parallel)
+    for (int j = 0; j < num_bones; j++)
+    {
+        const AnmBoneKeys& bone_keys = keys[j];
+        AnmPos pos;
+
+        const std::vector<int>& rotation_frames = bone_keys.rotation_frames;
+        for (size_t k = 0; k + 1 < rotation_frames.size(); k++)
+        {
+            int first = rotation_frames[k];
+            int last = rotation_frames[k + 1];
+            const float* a = &bone_keys.rotations[k * 4];
+            bool hold = !memcmp(a, a + 4, 4 * sizeof(float));
+            double qa[4], qb[4];
+            for (int c = 0; c < 4; c++)
+            {
+                qa[c] = a[c];
+                qb[c] = a[4 + c];
+            }
+            for (int i = first; i < last; i++)
+            {
+                data.getPose(j, i, pos);
+                if (i == first || hold)
+                {
+                    memcpy(pos.rot, a, 4 * sizeof(float));
+                }
+                else
+                {
+                    double q[4];
+                    slerp(qa, qb, static_cast<double>(i - first) / (last - first), q);
+                    for (int c = 0; c < 4; c++)
+                        pos.rot[c] = static_cast<float>(q[c]);
+                }
+                data.setPose(j, i, pos);
+            }
+        }
+        if (!rotation_frames.empty())
+        {
+            data.getPose(j, rotation_frames.back(), pos);
+            memcpy(pos.rot, &bone_keys.rotations[bone_keys.rotations.size() - 4], 4 * sizeof(float));
+            data.setPose(j, rotation_frames.back(), pos);
+        }
+
+        const std::vector<int>& position_frames = bone_keys.position_frames;
+        for (size_t k = 0; k + 1 < position_frames.size(); k++)
+        {
+            int first = position_frames[k];
+            int last = position_frames[k + 1];
+            const float* a = &bone_keys.positions[k * 3];
+            bool hold = !memcmp(a, a + 3, 3 * sizeof(float));
+            for (int i = first; i < last; i++)
+            {
+                data.getPose(j, i, pos);
+                float t = (i == first || hold) ? 0.0f : static_cast<float>(i - first) / (last - first);
+                pos.x = a[0] + t * (a[3] - a[0]);
+                pos.y = a[1] + t * (a[4] - a[1]);
+                pos.z = a[2] + t * (a[5] - a[2]);
+                data.setPose(j, i, pos);
+            }
+        }
+        if (!position_frames.empty())
+        {
+            const float* v = &bone_keys.positions[bone_keys.positions.size() - 3];
+            data.getPose(j, position_frames.back(), pos);
+            pos.x = v[0];
+            pos.y = v[1];
+            pos.z = v[2];
+            data.setPose(j, position_frames.back(), pos);
+        }
+    }
+
+    return MS::kSuccess;
+}
+
+} // namespace riot
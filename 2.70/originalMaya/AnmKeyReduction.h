@@ -0,0 +1,90 @@
+/*
+    Copyright 2011 Even Entem (alias ThiSpawn).
+
+    This file is part of Riot File Translator Plug-in for AutoDesk Maya.
+
+    Autodesk Maya's lib is under :
+    Copyright 1995, 2006, 2008 Autodesk, Inc. All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful, 
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef RIOT__ANMKEYREDUCTION_H
+#define RIOT__ANMKEYREDUCTION_H
+
+#include <vector>
+
+#include <maya/MStatus.h>
+
+namespace riot {
+
+struct AnmData;
+
+// how far the rebuilt poses may be from the sampled ones
+struct AnmTolerance
+{
+    AnmTolerance() : angle(0.0f), position(0.0f) {}
+    AnmTolerance(float angle_, float position_) : angle(angle_), position(position_) {}
+
+    float angle; // radians
+    float position;
+};
+
+// the keys kept for a bone, rotations and positions apart. the first and
+// the last frames are always keys, between two keys the poses are rebuilt
+// with slerp / lerp.
+struct AnmBoneKeys
+{
+    AnmBoneKeys() : max_angle_error(0.0f), max_position_error(0.0f) {}
+
+    std::vector<int> rotation_frames;
+    std::vector<float> rotations; // x y z w per key
+    std::vector<int> position_frames;
+    std::vector<float> positions; // x y z per key
+
+    // of the rebuilt poses against the sampled ones
+    float max_angle_error;
+    float max_position_error;
+};
+
+struct AnmReductionReport
+{
+    AnmReductionReport()
+        : num_frames(0), num_rotation_keys(0), num_position_keys(0), num_static_bones(0),
+          max_angle_error(0.0f), max_position_error(0.0f)
+    {
+    }
+
+    long long num_frames; // frames * bones, the keys there were
+    long long num_rotation_keys;
+    long long num_position_keys;
+    int num_static_bones; // only a first and a last key
+    float max_angle_error;
+    float max_position_error;
+};
+
+// keeps the fewest keys, segment after segment, such that every frame
+// between two keys is rebuilt within the tolerance of its bone.
+// tolerances has one entry for all the bones, or one per bone.
+// the bones are split between threads with openmp when parallel.
+MStatus reduceKeys(const AnmData& data, const std::vector<AnmTolerance>& tolerances,
+                   std::vector<AnmBoneKeys>& keys, AnmReductionReport& report, bool parallel = true);
+
+// replaces the poses of data with the ones rebuilt from keys. frames
+// between two equal keys get exactly that key, so the version 4 pools
+// store it once. keys needs one entry per bone of data.
+MStatus applyKeys(const std::vector<AnmBoneKeys>& keys, AnmData& data, bool parallel = true);
+
+} // namespace riot
+
+#endif
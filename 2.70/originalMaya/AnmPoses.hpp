@@ -0,0 +1,187 @@
+/*
+    Copyright 2011 Even Entem (alias ThiSpawn).
+
+    This file is part of Riot File Translator Plug-in for AutoDesk Maya.
+
+    Autodesk Maya's lib is under :
+    Copyright 1995, 2006, 2008 Autodesk, Inc. All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful, 
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef RIOT__ANMPOSES_HPP
+#define RIOT__ANMPOSES_HPP
+
+#include <AlignedArray.hpp>
+
+namespace riot {
+
+// planes of the pose components, rotation x y z w then position x y z
+enum AnmPlane
+{
+    kPlaneRotX = 0,
+    kPlaneRotY,
+    kPlaneRotZ,
+    kPlaneRotW,
+    kPlanePosX,
+    kPlanePosY,
+    kPlanePosZ,
+    kNumPlanes
+};
+
+// the poses of one frame (count bones, stride 1) or of one bone (count
+// frames, stride num_bones) in an AnmPoseBuffer. T is float or const float.
+template <class T>
+struct AnmPoseView
+{
+    T* plane[kNumPlanes];
+    int count;
+    int stride;
+
+    T& at(int plane_index, int i) const { return plane[plane_index][i * stride]; }
+
+    template <class Pos>
+    void get(int i, Pos& pos) const
+    {
+        int offset = i * stride;
+        pos.rot[0] = plane[kPlaneRotX][offset];
+        pos.rot[1] = plane[kPlaneRotY][offset];
+        pos.rot[2] = plane[kPlaneRotZ][offset];
+        pos.rot[3] = plane[kPlaneRotW][offset];
+        pos.x = plane[kPlanePosX][offset];
+        pos.y = plane[kPlanePosY][offset];
+        pos.z = plane[kPlanePosZ][offset];
+    }
+
+    template <class Pos>
+    void set(int i, const Pos& pos) const
+    {
+        int offset = i * stride;
+        plane[kPlaneRotX][offset] = pos.rot[0];
+        plane[kPlaneRotY][offset] = pos.rot[1];
+        plane[kPlaneRotZ][offset] = pos.rot[2];
+        plane[kPlaneRotW][offset] = pos.rot[3];
+        plane[kPlanePosX][offset] = pos.x;
+        plane[kPlanePosY][offset] = pos.y;
+        plane[kPlanePosZ][offset] = pos.z;
+    }
+};
+
+// all the poses of an animation in one allocation, frame after frame :
+// a plane holds one component for [frame * num_bones + bone].
+// a frame is contiguous in each plane (playback, sampling, compression),
+// a bone is strided by num_bones.
+// planes start on a 32 bytes boundary, for SIMD loads over the bones.
+class AnmPoseBuffer
+{
+public:
+    static const int kPlaneAlignment = 8; // floats
+
+    AnmPoseBuffer()
+        : num_frames_(0), num_bones_(0), plane_size_(0)
+    {
+    }
+
+    // the poses are zeroed
+    void resize(int num_frames, int num_bones)
+    {
+        num_frames_ = num_frames > 0 ? num_frames : 0;
+        num_bones_ = num_bones > 0 ? num_bones : 0;
+        int size = num_frames_ * num_bones_;
+        plane_size_ = (size + kPlaneAlignment - 1) / kPlaneAlignment * kPlaneAlignment;
+        planes_.clear();
+        planes_.resize(plane_size_ * kNumPlanes);
+    }
+
+    void clear()
+    {
+        planes_.clear();
+        num_frames_ = 0;
+        num_bones_ = 0;
+        plane_size_ = 0;
+    }
+
+    // drops the bones whose keep[bone] is 0, in place. the others keep
+    // their order.
+    void keepBones(const char* keep)
+    {
+        int num_kept = 0;
+        for (int b = 0; b < num_bones_; b++)
+            num_kept += keep[b] ? 1 : 0;
+        if (num_kept == num_bones_)
+            return;
+
+        // frame after frame, the kept columns only move down
+        for (int i = 0; i < kNumPlanes; i++)
+        {
+            float* values = plane(i);
+            int out = 0;
+            for (int f = 0; f < num_frames_; f++)
+            {
+                const float* in = values + f * num_bones_;
+                for (int b = 0; b < num_bones_; b++)
+                {
+                    if (keep[b])
+                        values[out++] = in[b];
+                }
+            }
+        }
+        num_bones_ = num_kept;
+    }
+
+    bool empty() const { return num_frames_ * num_bones_ == 0; }
+    int numFrames() const { return num_frames_; }
+    int numBones() const { return num_bones_; }
+
+    float* plane(int plane_index) { return planes_.data() + plane_index * plane_size_; }
+    const float* plane(int plane_index) const { return planes_.data() + plane_index * plane_size_; }
+
+    AnmPoseView<float> frame(int frame_index)
+    {
+        return view<float>(planes_.data(), frame_index * num_bones_, num_bones_, 1);
+    }
+    AnmPoseView<const float> frame(int frame_index) const
+    {
+        return view<const float>(planes_.data(), frame_index * num_bones_, num_bones_, 1);
+    }
+
+    AnmPoseView<float> bone(int bone_index)
+    {
+        return view<float>(planes_.data(), bone_index, num_frames_, num_bones_);
+    }
+    AnmPoseView<const float> bone(int bone_index) const
+    {
+        return view<const float>(planes_.data(), bone_index, num_frames_, num_bones_);
+    }
+
+private:
+    template <class T>
+    AnmPoseView<T> view(T* planes, int offset, int count, int stride) const
+    {
+        AnmPoseView<T> result;
+        for (int i = 0; i < kNumPlanes; i++)
+            result.plane[i] = planes + i * plane_size_ + offset;
+        result.count = count;
+        result.stride = stride;
+        return result;
+    }
+
+    int num_frames_;
+    int num_bones_;
+    int plane_size_;
+    AlignedArray<float> planes_;
+};
+
+} // namespace riot
+
+#endif
@@ -27,15 +27,59 @@
 #include <maya/MTransformationMatrix.h>
 #include <maya/MVector.h>
 #include <maya/MDagPath.h>
-#include <maya/MSelectionList.h>
-#include <maya/MItSelectionList.h>
 #include <maya/MQuaternion.h>
-#include <maya/MItDag.h>
 
 #include <maya_misc.h>
+#include <JointIndex.h>
+#include <AnmSampler.h>
+#ifndef RIOT_HEADLESS
+#include <AnmCurves.h>
+#endif
 
 namespace riot {
 
+namespace {
+
+// end of the v4 header, where the pools can start
+const int kV4HeaderEnd = 76;
+// the frame table is 12 bytes per (frame, bone)
+const int kV4FrameEntrySize = 12;
+
+// where the v4 pools and frame table are in the file
+struct V4Layout
+{
+    int positions_offset;
+    int quaternions_offset;
+    int frames_offset;
+    int num_pos;
+    int num_quat;
+};
+
+// from the offsets of the header, which count from the data size. false
+// unless positions <= quaternions <= frames and all of it fits in length
+bool v4Layout(int positions_offset, int quaternions_offset, int frames_offset,
+              int num_bones, int num_frames, long long length, V4Layout& layout)
+{
+    long long positions = 12LL + positions_offset;
+    long long quaternions = 12LL + quaternions_offset;
+    long long frames = 12LL + frames_offset;
+    if (num_bones < 0 || num_frames < 0 || positions < kV4HeaderEnd ||
+        positions > quaternions || quaternions > frames)
+        return false;
+    if (frames + static_cast<long long>(num_frames) * num_bones * kV4FrameEntrySize > length)
+        return false;
+
+    layout.positions_offset = static_cast<int>(positions);
+    layout.quaternions_offset = static_cast<int>(quaternions);
+    layout.frames_offset = static_cast<int>(frames);
+    layout.num_pos = static_cast<int>((quaternions - positions) / 12);
+    layout.num_quat = static_cast<int>((frames - quaternions) / 16);
+    return true;
+}
+
+} // namespace
+
+template <class Hand>
 MStatus AnmReader::read(istream& file)
 {
     // get length
@@ -73,38 +117,58 @@ MStatus AnmReader::read(istream& file)
         int num_frames;
         file.read(reinterpret_cast<char*>(&num_frames), 4);
 
-        // get fps (algorithm seen during the reversing)
+        // get fps (algorithm seen during the reversing), it is an unsigned
+        // int as the writer stores it, not the bits of a float
         float fps;
-        float ffps;
-        file.read(reinterpret_cast<char*>(&ffps), 4);
+        int ifps;
+        file.read(reinterpret_cast<char*>(&ifps), 4);
+        float ffps = static_cast<float>(ifps);
         if (ffps < 0.0f)
             fps = ffps + 4294967296.0f;
         else
             fps = ffps;
         data_.fps = fps;
 
-        // check minimum length
-        minlen += num_bones * num_frames * AnmPos::kSizeInFile + num_bones * AnmBone::kHeaderSize;
-        if (length < minlen)
+        if (num_bones < 0 || num_frames < 0)
+            FAILURE("AnmReader: bad counts");
+
+        // check minimum length, before anything is sized from the counts
+        long long needed = minlen + static_cast<long long>(num_bones) * num_frames * AnmPos::kSizeInFile +
+                           static_cast<long long>(num_bones) * AnmBone::kHeaderSize;
+        if (length < needed)
             FAILURE("AnmReader: unexpected end of file");
         data_.num_bones = num_bones;
         data_.num_frames = num_frames;
 
-        // get bones with frames
+        // get bones with frames, a bone's frames in one read
+        if (packed_)
+            data_.pose_buffer.resize(num_frames, num_bones);
+        std::vector<AnmPos> poses(num_frames);
+        data_.bones.resize(num_bones);
         for (int i = 0; i < num_bones; i++)
         {
-            AnmBone bone;
-            file.read(reinterpret_cast<char*>(&bone), AnmBone::kHeaderSize);
+            AnmBone& bone = data_.bones[i];
+            file.read(bone.name, AnmBone::kNameLen);
+            file.read(reinterpret_cast<char*>(&bone.flag), 4);
+            if (num_frames)
+                file.read(reinterpret_cast<char*>(&poses[0]), num_frames * AnmPos::kSizeInFile);
             for (int j = 0; j < num_frames; j++)
             {
-                AnmPos pos;
-                file.read(reinterpret_cast<char*>(&pos), AnmPos::kSizeInFile);
-                bone.poses.push_back(pos);
+                Hand::quaternion(poses[j].rot);
+                Hand::position(poses[j].x, poses[j].y, poses[j].z);
             }
-            data_.bones.push_back(bone);
-        }
 
-        data_.switchHand();
+            if (packed_)
+            {
+                AnmPoseView<float> view = data_.pose_buffer.bone(i);
+                for (int j = 0; j < num_frames; j++)
+                    view.set(j, poses[j]);
+            }
+            else
+            {
+                bone.poses = poses;
+            }
+        }
     }
     else if (version == 4)
     {
@@ -163,56 +227,93 @@ MStatus AnmReader::read(istream& file)
         int frames_offset;
         file.read(reinterpret_cast<char*>(&frames_offset), 4);
 
-        int num_pos = (quaternions_offset - positions_offset) / 12;
-        int num_quat = (frames_offset - quaternions_offset) / 16;
-
         // 3 bytes unused
         file.seekg(12, ios::cur);
 
+        V4Layout layout;
+        if (!v4Layout(positions_offset, quaternions_offset, frames_offset, num_bones, num_frames, length, layout))
+            FAILURE("AnmReader: v4, the pools or the frames are out of the file");
+        int num_pos = layout.num_pos;
+        int num_quat = layout.num_quat;
+        long long frames_size = static_cast<long long>(num_frames) * num_bones * kV4FrameEntrySize;
+
         // fill positions vector
-        Vec3* positions = reinterpret_cast<Vec3*>(malloc(num_pos * sizeof(Vec3)));
-        file.read(reinterpret_cast<char*>(positions), num_pos * sizeof(Vec3));
+        std::vector<Vec3> positions(num_pos);
+        file.seekg(layout.positions_offset, ios::beg);
+        if (num_pos)
+            file.read(reinterpret_cast<char*>(&positions[0]), num_pos * sizeof(Vec3));
 
         // fill quaternions vector
-        Quat* quaternions = reinterpret_cast<Quat*>(malloc(num_quat * sizeof(Quat)));
-        file.read(reinterpret_cast<char*>(quaternions), num_quat * sizeof(Quat));
+        std::vector<Quat> quaternions(num_quat);
+        file.seekg(layout.quaternions_offset, ios::beg);
+        if (num_quat)
+            file.read(reinterpret_cast<char*>(&quaternions[0]), num_quat * sizeof(Quat));
+        if (!file)
+            FAILURE("AnmReader: unexpected end of file");
+
+        // the frames only index the pools, so these are converted once
+        // instead of once per frame using them
+        for (int i = 0; i < num_pos; i++)
+            Hand::position(positions[i].x, positions[i].y, positions[i].z);
+        for (int i = 0; i < num_quat; i++)
+            Hand::quaternion(quaternions[i].q);
+
+        // get the frame table in one read
+        std::vector<char> frames(static_cast<size_t>(frames_size));
+        file.seekg(layout.frames_offset, ios::beg);
+        if (frames_size)
+            file.read(&frames[0], frames_size);
+        if (!file)
+            FAILURE("AnmReader: unexpected end of file");
 
         // get bones with frames
-        
-        for (int i = 0; i < num_bones; i++)
+        data_.bones.resize(num_bones);
+        if (packed_)
         {
-            AnmBone bone;
-            data_.bones.push_back(bone);
+            data_.pose_buffer.resize(num_frames, num_bones);
+        }
+        else
+        {
+            for (int j = 0; j < num_bones; j++)
+                data_.bones[j].poses.resize(num_frames);
         }
 
+        // entry : name hash (4), pos id (2), pos id from unit pos (2, useless for us),
+        // quat id (2), 0 (2)
+        const char* entry = frames.empty() ? 0 : &frames[0];
+        AnmPos pos;
         for (int i = 0; i < num_frames; i++)
         {
-            for (int j = 0; j < num_bones; j++)
+            AnmPoseView<float> frame = AnmPoseView<float>();
+            if (packed_)
+                frame = data_.pose_buffer.frame(i);
+            for (int j = 0; j < num_bones; j++, entry += kV4FrameEntrySize)
             {
-                int name_hash;
-                file.read(reinterpret_cast<char*>(&name_hash), 4);
                 WORD pos_id;
-                file.read(reinterpret_cast<char*>(&pos_id), 2);
-                file.seekg(2, ios::cur); // pos id from unit pos, useless for us
+                memcpy(&pos_id, entry + 4, 2);
                 WORD quat_id;
-                file.read(reinterpret_cast<char*>(&quat_id), 2);
-                file.seekg(2, ios::cur); // 0
+                memcpy(&quat_id, entry + 8, 2);
+                if (pos_id >= num_pos || quat_id >= num_quat)
+                    FAILURE("AnmReader: v4, a frame is out of the pools");
 
                 if (i == 0)
-                    data_.bones.at(j).name_hash = name_hash;
-
-                AnmPos pos;
-                memcpy(&(pos.x), positions + pos_id, sizeof(Vec3));
-                memcpy(pos.rot, quaternions + quat_id, sizeof(Quat));
-
-                data_.bones.at(j).poses.push_back(pos);
+                    memcpy(&data_.bones[j].name_hash, entry, 4);
+
+                const Vec3& position = positions[pos_id];
+                const Quat& quaternion = quaternions[quat_id];
+                pos.x = position.x;
+                pos.y = position.y;
+                pos.z = position.z;
+                pos.rot[0] = quaternion.q[0];
+                pos.rot[1] = quaternion.q[1];
+                pos.rot[2] = quaternion.q[2];
+                pos.rot[3] = quaternion.q[3];
+                if (packed_)
+                    frame.set(j, pos);
+                else
+                    data_.bones[j].poses[i] = pos;
             }
         }
-
-        free(positions);
-        free(quaternions);
-
-        data_.switchHand();
     }
     else
     {
@@ -222,128 +323,220 @@ MStatus AnmReader::read(istream& file)
     return MS::kSuccess;
 }
 
-MStatus AnmReader::loadData()
+template MStatus AnmReader::read<SwitchHand>(istream& file);
+template MStatus AnmReader::read<KeepHand>(istream& file);
+
+namespace {
+
+template <class T>
+T valueAt(const char* data, long long offset)
 {
-    // the bones don't need to be in hierarchical order
-    // prevent update for later type versions.
+    T value;
+    memcpy(&value, data + offset, sizeof(T));
+    return value;
+}
 
-    MFnIkJoint fn_joint;
-    
-    MStatus status;
-    MDagPath dag_path;
+} // namespace
 
-    data_.joints.clear();
+MStatus AnmReader::open(const char* file_name)
+{
+    close();
+    if (!mapped_.open(file_name))
+        FAILURE(MString("AnmReader: ") + file_name + " : could not be mapped");
+
+    MStatus status = readIndex();
+    if (status != MS::kSuccess)
+        close();
+    return status;
+}
 
-    MString command("setKeyframe -breakdown 0 -hierarchy none -controlPoints 0 -shape 0" \
-                    "-at translateX -at translateY -at translateZ" \
-                    "-at rotateX -at rotateY -at rotateZ");
+MStatus AnmReader::readIndex()
+{
+    const char* data = mapped_.data();
+    long long length = mapped_.size();
+    if (length < 28)
+        FAILURE("AnmReader: the file is empty!");
+    if (strncmp(data, "r3d2anmd", 8))
+        FAILURE("AnmReader: magic is wrong!");
 
-    // get paths
-    for (int i = 0; i < data_.num_bones; i++)
+    data_ = AnmData();
+    data_.version = valueAt<int>(data, 8);
+    if (data_.version == 3)
     {
-        if (data_.bones[i].name_hash != 0) // for version 4
+        int num_bones = valueAt<int>(data, 16);
+        int num_frames = valueAt<int>(data, 20);
+        float ffps = static_cast<float>(valueAt<int>(data, 24));
+        data_.fps = ffps < 0.0f ? ffps + 4294967296.0f : ffps;
+        if (num_bones < 0 || num_frames < 0)
+            FAILURE("AnmReader: bad counts");
+
+        long long bone_size = AnmBone::kHeaderSize + static_cast<long long>(num_frames) * AnmPos::kSizeInFile;
+        if (28 + num_bones * bone_size > length)
+            FAILURE("AnmReader: unexpected end of file");
+
+        // the bones follow each other, header then every frame
+        data_.bones.resize(num_bones);
+        bone_offsets_.resize(num_bones);
+        for (int i = 0; i < num_bones; i++)
         {
-            MItDag it_dag(MItDag::kDepthFirst, MFn::kJoint, &status);
-            if (status != MStatus::kSuccess)
-                FAILURE("AnmReader: MItDag::MItDag()");
+            long long offset = 28 + i * bone_size;
+            AnmBone& bone = data_.bones[i];
+            memcpy(bone.name, data + offset, AnmBone::kNameLen);
+            bone.flag = valueAt<int>(data, offset + AnmBone::kNameLen);
+            bone_offsets_[i] = static_cast<int>(offset + AnmBone::kHeaderSize);
+        }
+        data_.num_bones = num_bones;
+        clip_frames_ = num_frames;
+    }
+    else if (data_.version == 4)
+    {
+        if (length < kV4HeaderEnd || 12LL + valueAt<int>(data, 12) > length)
+            FAILURE("AnmReader: unexpected end of file");
+        if (valueAt<unsigned int>(data, 16) != 0xBE0794D3)
+            FAILURE("AnmReader: v4, magic is wrong!");
 
-            int tested_hash;
-            int name_hash = data_.bones[i].name_hash;
-            MString joint_name;
+        int num_bones = valueAt<int>(data, 28);
+        int num_frames = valueAt<int>(data, 32);
+        float ffps = valueAt<float>(data, 36);
+        data_.fps = ffps < 1.0f ? 1.0f / ffps : ffps;
+
+        V4Layout layout;
+        if (!v4Layout(valueAt<int>(data, 52), valueAt<int>(data, 56), valueAt<int>(data, 60),
+                      num_bones, num_frames, length, layout))
+            FAILURE("AnmReader: v4, the pools or the frames are out of the file");
+        positions_offset_ = layout.positions_offset;
+        quaternions_offset_ = layout.quaternions_offset;
+        frames_offset_ = layout.frames_offset;
+        num_pos_ = layout.num_pos;
+        num_quat_ = layout.num_quat;
+
+        // the names are only in the first row of the frame table
+        data_.bones.resize(num_bones);
+        if (num_frames > 0)
+        {
+            for (int j = 0; j < num_bones; j++)
+                data_.bones[j].name_hash = valueAt<int>(data, frames_offset_ + j * kV4FrameEntrySize);
+        }
+        data_.num_bones = num_bones;
+        clip_frames_ = num_frames;
+    }
+    else
+    {
+        FAILURE("AnmReader: anm type not supported, \n please report that to ThiSpawn");
+    }
 
-            for (; !it_dag.isDone(); it_dag.next())
-            {
-                it_dag.getPath(dag_path);
-                MFnIkJoint joint(dag_path);
-                joint_name = joint.name();
-                tested_hash = hashName(joint_name.asChar());
-                if (name_hash == tested_hash)
-                {
-                    data_.joints.append(dag_path);
-                    break;
-                }
-            }
+    data_.num_frames = 0;
+    return MS::kSuccess;
+}
 
-            if (it_dag.isDone())
-            {
-                MGlobal::displayWarning(MString("AnmReader: no bone with name hash (int)")
-                                        + name_hash
-                                        + " found.");
-                data_.bones.erase(data_.bones.begin() + i);
-                data_.num_bones -= 1;
-                i--;
-            }
-            else
+template <class Hand>
+const char* AnmReader::decodeFrames(int first, int count)
+{
+    if (!mapped_.isOpen())
+        return "AnmReader: readFrames() without open()";
+    if (first < 0 || count < 0 || first > clip_frames_ - count)
+        return "AnmReader: the frames are out of the clip";
+
+    const char* data = mapped_.data();
+    int num_bones = data_.num_bones;
+    if (packed_)
+    {
+        data_.pose_buffer.resize(count, num_bones);
+    }
+    else
+    {
+        data_.pose_buffer.clear();
+        for (int j = 0; j < num_bones; j++)
+            data_.bones[j].poses.resize(count);
+    }
+
+    AnmPos pos;
+    if (data_.version == 3)
+    {
+        for (int j = 0; j < num_bones; j++)
+        {
+            const char* poses = data + bone_offsets_[j] + static_cast<long long>(first) * AnmPos::kSizeInFile;
+            AnmPoseView<float> view = AnmPoseView<float>();
+            if (packed_)
+                view = data_.pose_buffer.bone(j);
+            for (int i = 0; i < count; i++)
             {
-                command += " " + joint_name;
+                memcpy(&pos, poses + i * AnmPos::kSizeInFile, AnmPos::kSizeInFile);
+                Hand::quaternion(pos.rot);
+                Hand::position(pos.x, pos.y, pos.z);
+                if (packed_)
+                    view.set(i, pos);
+                else
+                    data_.bones[j].poses[i] = pos;
             }
         }
-        else
+    }
+    else
+    {
+        // the pools are read from the mapping, so only the window is in memory
+        const char* entry = data + frames_offset_ + static_cast<long long>(first) * num_bones * kV4FrameEntrySize;
+        for (int i = 0; i < count; i++)
         {
-            MString bone_name(data_.bones[i].name);
-            status = MGlobal::selectByName(bone_name, MGlobal::ListAdjustment::kReplaceList);
-            if (status == MS::kSuccess)
+            AnmPoseView<float> frame = AnmPoseView<float>();
+            if (packed_)
+                frame = data_.pose_buffer.frame(i);
+            for (int j = 0; j < num_bones; j++, entry += kV4FrameEntrySize)
             {
-                MSelectionList active_list;
-                MGlobal::getActiveSelectionList(active_list);
-                if (active_list.length() != 1)
-                    FAILURE("AnmReader: too much bones named : " + bone_name);
-
-                MItSelectionList iter(active_list, MFn::kJoint);
-
-                // only one object is selected
-                if (iter.isDone())
-                {
-                    MGlobal::displayWarning("AnmReader: " + bone_name + " is not a joint ...");
-                    continue;
-                }
-
-                iter.getDagPath(dag_path);
-                data_.joints.append(dag_path);
-                MFnIkJoint joint(dag_path);
-                command += " " + joint.name();
-            }
-            else // try to find the bone without the maya case sensitive way
-            {
-                MItDag it_dag(MItDag::kDepthFirst, MFn::kJoint, &status);
-                if (status != MStatus::kSuccess)
-                    FAILURE("AnmReader: MItDag::MItDag()");
-
-                MString low_bone_name = bone_name;
-                low_bone_name.toLowerCase();
-                MString joint_name;
-
-                for (; !it_dag.isDone(); it_dag.next())
-                {
-                    it_dag.getPath(dag_path);
-                    MFnIkJoint joint(dag_path);
-                    MString low_joint_name = joint.name();
-                    low_joint_name.toLowerCase();
-                    if (low_bone_name == low_joint_name)
-                    {
-                        data_.joints.append(dag_path);
-                        joint_name = joint.name();
-                        break;
-                    }
-                }
-
-                if (it_dag.isDone())
-                {
-                    MGlobal::displayWarning("AnmReader: no bone named " + MString(data_.bones[i].name) + " found.");
-                    data_.bones.erase(data_.bones.begin() + i);
-                    data_.num_bones -= 1;
-                    i--;
-                }
+                WORD pos_id = valueAt<WORD>(entry, 4);
+                WORD quat_id = valueAt<WORD>(entry, 8);
+                if (pos_id >= num_pos_ || quat_id >= num_quat_)
+                    return "AnmReader: v4, a frame is out of the pools";
+
+                memcpy(&pos.x, data + positions_offset_ + pos_id * 12, 12);
+                memcpy(pos.rot, data + quaternions_offset_ + quat_id * 16, 16);
+                Hand::quaternion(pos.rot);
+                Hand::position(pos.x, pos.y, pos.z);
+                if (packed_)
+                    frame.set(j, pos);
                 else
-                {
-                    command += " " + joint_name;
-                }
+                    data_.bones[j].poses[i] = pos;
             }
         }
     }
 
-    if (data_.num_bones <= 1)
-        MGlobal::displayWarning("AnmReader: erm .. is this an anm for this champ ??? oO");
+    data_.num_frames = count;
+    window_start_ = first;
+    return 0;
+}
+
+template <class Hand>
+MStatus AnmReader::readFrames(int first, int count)
+{
+    const char* error = decodeFrames<Hand>(first, count);
+    if (error)
+        FAILURE(error);
+    return MS::kSuccess;
+}
+
+void AnmReader::close()
+{
+    mapped_.close();
+    clip_frames_ = 0;
+    window_start_ = 0;
+    bone_offsets_.clear();
+    positions_offset_ = 0;
+    quaternions_offset_ = 0;
+    frames_offset_ = 0;
+    num_pos_ = 0;
+    num_quat_ = 0;
+}
+
+template MStatus AnmReader::readFrames<SwitchHand>(int first, int count);
+template const char* AnmReader::decodeFrames<SwitchHand>(int first, int count);
+template const char* AnmReader::decodeFrames<KeepHand>(int first, int count);
+template MStatus AnmReader::readFrames<KeepHand>(int first, int count);
+
+#ifndef RIOT_HEADLESS
+
+MStatus AnmReader::loadData()
+{
+    if (loadData(0.0, true) != MS::kSuccess)
+        return MS::kFailure;
 
     // set anim config
     MString playback_options("playbackOptions -e");
@@ -360,46 +553,104 @@ MStatus AnmReader::loadData()
 
     MGlobal::executeCommand(playback_options);
 
-    int num_bones = data_.num_bones;
-    int num_frames = data_.num_frames;
-    for (int i = 0; i < num_frames; i++)
-    {
-        MGlobal::executeCommand(MString("currentTime ") + i);
-        /*
-        The transformation matrix for a joint node is below.
+    return MS::kSuccess;
+}
 
-            matrix = [S] * [RO] * [R] * [JO] * [IS] * [T]
+MStatus AnmReader::loadData(double start_time, bool begin_lookups)
+{
+    // the bones don't need to be in hierarchical order
+    // prevent update for later type versions.
 
-        (where '*' denotes matrix multiplication).
+    MStatus status;
+    MDagPath dag_path;
 
-        These matrices are defined as follows:
+    data_.joints.clear();
 
-            [S] : scale
-            [RO] : rotateOrient (attribute name is rotateAxis)
-            [R] : rotate
-            [JO] : jointOrient
-            [IS] : parentScaleInverse
-            [T] : translate
-        */
-        for (int j = 0; j < num_bones; j++)
+    // the joint index is shared by the imports of the session
+    JointIndex& index = JointIndex::sessionIndex();
+    if (begin_lookups)
+        index.beginLookups();
+    int num_misses = 0;
+    std::vector<char> found(data_.bones.size(), 1);
+
+    // get paths
+    for (int i = 0; i < data_.num_bones; i++)
+    {
+        if (data_.bones[i].name_hash != 0) // for version 4
+            status = index.findByHash(data_.bones[i].name_hash, dag_path);
+        else
+            status = index.findByName(data_.bones[i].name, dag_path);
+
+        if (status == MS::kSuccess)
         {
-            AnmPos pos = data_.bones[j].poses[i];
-            fn_joint.setObject(data_.joints[j]);
-            MQuaternion rotation(pos.rot[0], pos.rot[1], pos.rot[2], pos.rot[3]);
-            MQuaternion orient, axe;
-            fn_joint.getOrientation(orient);
-            axe = fn_joint.rotateOrientation(MSpace::kTransform);
-            rotation = axe.inverse() * rotation * orient.inverse();
-            fn_joint.setRotation(rotation, MSpace::kTransform);
-            MVector vec(pos.x, pos.y, pos.z);
-            fn_joint.setTranslation(vec, MSpace::kTransform);
+            data_.joints.append(dag_path);
+            continue;
         }
 
-        MGlobal::executeCommand(command);
+        if (status == MS::kFailure)
+            FAILURE("AnmReader: too much bones named : " + MString(data_.bones[i].name));
+
+        if (data_.bones[i].name_hash != 0)
+            MGlobal::displayWarning(MString("AnmReader: no bone with name hash (int)")
+                                    + data_.bones[i].name_hash
+                                    + " found.");
+        else
+            MGlobal::displayWarning("AnmReader: no bone named " + MString(data_.bones[i].name) + " found.");
+        found[i] = 0;
+        num_misses++;
+    }
+
+    if (num_misses > 0)
+    {
+        // the packed poses lose their columns too, the joints stay in step
+        data_.keepBones(found);
+
+        const JointIndex::Stats& stats = index.stats();
+        MGlobal::displayInfo(MString("AnmReader: ") + num_misses + " bones not found in "
+                             + index.numJoints() + " joints (session : "
+                             + stats.misses + " misses in " + stats.lookups + " lookups)");
+    }
+
+    if (data_.num_bones <= 1)
+        MGlobal::displayWarning("AnmReader: erm .. is this an anm for this champ ??? oO");
+
+    /*
+    The transformation matrix for a joint node is below.
+
+        matrix = [S] * [RO] * [R] * [JO] * [IS] * [T]
+
+    (where '*' denotes matrix multiplication).
+
+    These matrices are defined as follows:
+
+        [S] : scale
+        [RO] : rotateOrient (attribute name is rotateAxis)
+        [R] : rotate
+        [JO] : jointOrient
+        [IS] : parentScaleInverse
+        [T] : translate
+
+    the poses are [RO] * [R] * [JO], the curves get [R] as euler angles.
+    */
+    int num_bones = data_.num_bones;
+    int num_frames = data_.num_frames;
+    MayaCurveSource joints(data_.joints);
+    std::vector<AnmJointSetup> setups(num_bones);
+    for (int j = 0; j < num_bones; j++)
+        joints.getSetup(j, setups[j]);
+
+    std::vector<double> values(static_cast<size_t>(num_bones) * num_frames * AnmCurveSource::kNumChannels);
+    if (!values.empty())
+    {
+        extractChannels(data_, &setups[0], num_frames, &values[0]);
+        if (keyChannels(data_.joints, &values[0], start_time, num_frames) != MS::kSuccess)
+            FAILURE("AnmReader: keyChannels()");
     }
 
     return MS::kSuccess;
 }
 
+#endif // RIOT_HEADLESS
+
 } // namespace riot
 
@@ -28,17 +28,72 @@
 #include <maya/MIOStream.h>
 
 #include <AnmData.hpp>
+#include <Handedness.hpp>
+#include <MappedFile.h>
 
 namespace riot {
 
 class AnmReader
 {
 public:
-    MStatus read(istream& file);
+    AnmReader()
+        : packed_(false), clip_frames_(0), window_start_(0),
+          positions_offset_(0), quaternions_offset_(0), frames_offset_(0),
+          num_pos_(0), num_quat_(0)
+    {
+    }
+
+    // Hand is SwitchHand or KeepHand, see Handedness.hpp
+    template <class Hand> MStatus read(istream& file);
+    MStatus read(istream& file) { return read<SwitchHand>(file); }
+    // keys the clip on the joints from frame 0 and sets the playback
+    // options to it
     MStatus loadData();
+    // keys the clip from start_time on and leaves the playback options,
+    // the clips of a batch share the beginLookups() of the joint index
+    MStatus loadData(double start_time, bool begin_lookups);
+
+    // lazy mode, for a window of a long clip : open() maps the file and
+    // reads the header and the bones only, readFrames() decodes frames
+    // [first, first + count) from the mapping into data_, which then holds
+    // that window alone (data_.num_frames is count).
+    // the file stays mapped until close() or another open().
+    MStatus open(const char* file_name);
+    template <class Hand> MStatus readFrames(int first, int count);
+    MStatus readFrames(int first, int count) { return readFrames<SwitchHand>(first, count); }
+    // readFrames() which displays nothing, for the worker threads : returns
+    // the error message, 0 when the frames are decoded
+    template <class Hand> const char* decodeFrames(int first, int count);
+    const char* decodeFrames(int first, int count) { return decodeFrames<SwitchHand>(first, count); }
+    void close();
+
+    int clipFrames() const { return clip_frames_; }
+    int windowStart() const { return window_start_; }
 
-private:
     AnmData data_;
+
+    // decode the poses straight into data_.pose_buffer instead of the bones
+    bool packed_;
+
+private:
+    // not copyable, the mapping is owned
+    AnmReader(const AnmReader&);
+    AnmReader& operator=(const AnmReader&);
+
+    // header and bones of the mapped file
+    MStatus readIndex();
+
+    MappedFile mapped_;
+    int clip_frames_;
+    int window_start_;
+    // index of the mapped file : where each bone's poses start (v3), or
+    // the pools and the frame table (v4), from the start of the file
+    std::vector<int> bone_offsets_;
+    int positions_offset_;
+    int quaternions_offset_;
+    int frames_offset_;
+    int num_pos_;
+    int num_quat_;
 };
 
 } // namespace riot
@@ -0,0 +1,281 @@
+/*
+    Copyright 2011 Even Entem (alias ThiSpawn).
+
+    This file is part of Riot File Translator Plug-in for AutoDesk Maya.
+
+    Autodesk Maya's lib is under :
+    Copyright 1995, 2006, 2008 Autodesk, Inc. All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful, 
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <AnmResampler.h>
+
+#include <math.h>
+#include <string.h>
+
+#include <maya/MGlobal.h>
+
+#include <AnmData.hpp>
+#include <maya_misc.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RIOT_ANM_RESAMPLER_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace riot {
+
+namespace {
+
+// bones per task, a multiple of 4
+const int kBoneBlock = 64;
+
+// closer than that, slerp is nlerp (sin of the angle gets too small)
+const float kSlerpThreshold = 0.9995f;
+
+// the source planes of two frames and the output planes, from a bone on
+struct FramePair
+{
+    const float* from[kNumPlanes];
+    const float* to[kNumPlanes];
+    float* out[kNumPlanes];
+};
+
+// the slerp weights of the two rotations, for dot = cos of the angle (>= 0)
+void slerpWeights(float dot, float t, float& w0, float& w1)
+{
+    if (dot > kSlerpThreshold)
+    {
+        w0 = 1.0f - t;
+        w1 = t;
+        return;
+    }
+    float angle = acosf(dot);
+    float inv_sin = 1.0f / sinf(angle);
+    w0 = sinf((1.0f - t) * angle) * inv_sin;
+    w1 = sinf(t * angle) * inv_sin;
+}
+
+void blendScalar(const FramePair& p, int i, float t, AnmInterpolation interpolation)
+{
+    for (int c = kPlanePosX; c <= kPlanePosZ; c++)
+        p.out[c][i] = p.from[c][i] + t * (p.to[c][i] - p.from[c][i]);
+
+    float q0[4], q1[4];
+    for (int c = 0; c < 4; c++)
+    {
+        q0[c] = p.from[kPlaneRotX + c][i];
+        q1[c] = p.to[kPlaneRotX + c][i];
+    }
+
+    // the shortest way
+    float dot = q0[0] * q1[0] + q0[1] * q1[1] + q0[2] * q1[2] + q0[3] * q1[3];
+    if (dot < 0.0f)
+    {
+        dot = -dot;
+        for (int c = 0; c < 4; c++)
+            q1[c] = -q1[c];
+    }
+
+    float w0 = 1.0f - t;
+    float w1 = t;
+    if (interpolation == kInterpolateSlerp)
+        slerpWeights(dot, t, w0, w1);
+
+    float q[4];
+    float length = 0.0f;
+    for (int c = 0; c < 4; c++)
+    {
+        q[c] = w0 * q0[c] + w1 * q1[c];
+        length += q[c] * q[c];
+    }
+    float scale = length > 0.0f ? 1.0f / sqrtf(length) : 0.0f;
+    for (int c = 0; c < 4; c++)
+        p.out[kPlaneRotX + c][i] = q[c] * scale;
+}
+
+// bones [0, count) of a frame pair
+void blendBones(const FramePair& p, int count, float t, AnmInterpolation interpolation)
+{
+    int i = 0;
+#if defined(RIOT_ANM_RESAMPLER_SSE2)
+    const __m128 vt = _mm_set1_ps(t);
+    const __m128 sign_bit = _mm_set1_ps(-0.0f);
+    const __m128 zero = _mm_setzero_ps();
+    for (; i + 4 <= count; i += 4)
+    {
+        for (int c = kPlanePosX; c <= kPlanePosZ; c++)
+        {
+            __m128 a = _mm_loadu_ps(p.from[c] + i);
+            __m128 b = _mm_loadu_ps(p.to[c] + i);
+            _mm_storeu_ps(p.out[c] + i, _mm_add_ps(a, _mm_mul_ps(vt, _mm_sub_ps(b, a))));
+        }
+
+        __m128 q0[4], q1[4];
+        for (int c = 0; c < 4; c++)
+        {
+            q0[c] = _mm_loadu_ps(p.from[kPlaneRotX + c] + i);
+            q1[c] = _mm_loadu_ps(p.to[kPlaneRotX + c] + i);
+        }
+        __m128 dot = _mm_add_ps(_mm_add_ps(_mm_mul_ps(q0[0], q1[0]), _mm_mul_ps(q0[1], q1[1])),
+                                _mm_add_ps(_mm_mul_ps(q0[2], q1[2]), _mm_mul_ps(q0[3], q1[3])));
+
+        // the shortest way : flip the sign of q1 where dot < 0
+        __m128 flip = _mm_and_ps(_mm_cmplt_ps(dot, zero), sign_bit);
+        for (int c = 0; c < 4; c++)
+            q1[c] = _mm_xor_ps(q1[c], flip);
+        dot = _mm_xor_ps(dot, flip);
+
+        __m128 w0 = _mm_sub_ps(_mm_set1_ps(1.0f), vt);
+        __m128 w1 = vt;
+        if (interpolation == kInterpolateSlerp)
+        {
+            // the angles differ between bones, the weights come from libm
+            float dots[4], weights0[4], weights1[4];
+            _mm_storeu_ps(dots, dot);
+            for (int k = 0; k < 4; k++)
+                slerpWeights(dots[k], t, weights0[k], weights1[k]);
+            w0 = _mm_loadu_ps(weights0);
+            w1 = _mm_loadu_ps(weights1);
+        }
+
+        __m128 q[4];
+        __m128 length = zero;
+        for (int c = 0; c < 4; c++)
+        {
+            q[c] = _mm_add_ps(_mm_mul_ps(w0, q0[c]), _mm_mul_ps(w1, q1[c]));
+            length = _mm_add_ps(length, _mm_mul_ps(q[c], q[c]));
+        }
+        // 0 for a null quaternion instead of a nan
+        __m128 non_zero = _mm_cmpgt_ps(length, zero);
+        __m128 scale = _mm_and_ps(non_zero, _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(length)));
+        for (int c = 0; c < 4; c++)
+            _mm_storeu_ps(p.out[kPlaneRotX + c] + i, _mm_mul_ps(q[c], scale));
+    }
+#endif
+    for (; i < count; i++)
+        blendScalar(p, i, t, interpolation);
+}
+
+// out frame k is at source frame k * step
+void resample(const AnmPoseBuffer& source, double step, AnmInterpolation interpolation,
+              AnmPoseBuffer& poses, bool parallel)
+{
+    int num_bones = source.numBones();
+    int last_source = source.numFrames() - 1;
+    int num_frames = poses.numFrames();
+    int num_blocks = (num_bones + kBoneBlock - 1) / kBoneBlock;
+
+#pragma omp parallel for schedule(dynamic) if(parallel)
+    for (int block = 0; block < num_blocks; block++)
+    {
+        int first_bone = block * kBoneBlock;
+        int count = num_bones - first_bone < kBoneBlock ? num_bones - first_bone : kBoneBlock;
+
+        for (int k = 0; k < num_frames; k++)
+        {
+            double time = k * step;
+            int frame = static_cast<int>(floor(time));
+            if (frame >= last_source)
+            {
+                frame = last_source;
+                time = last_source;
+            }
+            float t = static_cast<float>(time - frame);
+
+            FramePair p;
+            for (int c = 0; c < kNumPlanes; c++)
+            {
+                p.from[c] = source.plane(c) + frame * num_bones + first_bone;
+                p.out[c] = poses.plane(c) + k * num_bones + first_bone;
+            }
+
+            // on a source frame, copied as is
+            if (t < 1e-6f)
+            {
+                for (int c = 0; c < kNumPlanes; c++)
+                    memcpy(p.out[c], p.from[c], count * sizeof(float));
+                continue;
+            }
+
+            for (int c = 0; c < kNumPlanes; c++)
+                p.to[c] = p.from[c] + num_bones;
+            blendBones(p, count, t, interpolation);
+        }
+    }
+}
+
+MStatus resampleWithStep(const AnmData& in, int num_frames, double step, AnmInterpolation interpolation,
+                         AnmData& out, bool parallel)
+{
+    // the poses of in, packed
+    AnmData packed_in;
+    const AnmData* source = &in;
+    if (!in.packed())
+    {
+        packed_in = in;
+        packed_in.packPoses();
+        source = &packed_in;
+    }
+
+    out.version = in.version;
+    out.num_bones = in.num_bones;
+    out.num_frames = num_frames;
+    out.fps = in.fps;
+    out.bones = in.bones;
+    for (size_t i = 0; i < out.bones.size(); i++)
+        std::vector<AnmPos>().swap(out.bones[i].poses);
+    out.joints = in.joints;
+    out.pose_buffer.resize(num_frames, source->pose_buffer.numBones());
+
+    resample(source->pose_buffer, step, interpolation, out.pose_buffer, parallel);
+    return MS::kSuccess;
+}
+
+} // namespace
+
+MStatus resampleAnimation(const AnmData& in, int num_frames, AnmInterpolation interpolation,
+                          AnmData& out, bool parallel)
+{
+    if (in.num_frames < 1 || num_frames < 1)
+        FAILURE("resampleAnimation: no frame to resample");
+    if (num_frames > 1 << 24)
+        FAILURE("resampleAnimation: too many frames");
+
+    double step = num_frames > 1 ? static_cast<double>(in.num_frames - 1) / (num_frames - 1) : 0.0;
+    MStatus status = resampleWithStep(in, num_frames, step, interpolation, out, parallel);
+    if (step > 0.0)
+        out.fps = static_cast<float>(in.fps / step);
+    return status;
+}
+
+MStatus resampleAnimationToFps(const AnmData& in, float fps, AnmInterpolation interpolation,
+                               AnmData& out, bool parallel)
+{
+    if (in.num_frames < 1 || in.fps <= 0.0f || fps <= 0.0f)
+        FAILURE("resampleAnimationToFps: no frame or no frame rate");
+
+    // a frame rate read from a broken header would ask for billions of frames
+    const double kMaxFrames = 1 << 24;
+    double step = static_cast<double>(in.fps) / fps;
+    double frames = floor((in.num_frames - 1) / step + 1e-6) + 1;
+    if (!(frames <= kMaxFrames))
+        FAILURE("resampleAnimationToFps: too many frames, is the frame rate of the clip right ?");
+    int num_frames = static_cast<int>(frames);
+    MStatus status = resampleWithStep(in, num_frames, step, interpolation, out, parallel);
+    out.fps = fps;
+    return status;
+}
+
+} // namespace riot
@@ -0,0 +1,53 @@
+/*
+    Copyright 2011 Even Entem (alias ThiSpawn).
+
+    This file is part of Riot File Translator Plug-in for AutoDesk Maya.
+
+    Autodesk Maya's lib is under :
+    Copyright 1995, 2006, 2008 Autodesk, Inc. All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful, 
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef RIOT__ANMRESAMPLER_H
+#define RIOT__ANMRESAMPLER_H
+
+#include <maya/MStatus.h>
+
+namespace riot {
+
+struct AnmData;
+
+enum AnmInterpolation
+{
+    kInterpolateNlerp = 0, // normalized lerp, fast, a bit off the arc at wide angles
+    kInterpolateSlerp = 1  // constant angular speed
+};
+
+// retimes in to num_frames frames over the same duration, the first and
+// the last frames are kept. out gets the bones of in and the poses packed
+// (see AnmData::packPoses), in can be packed or not.
+// the rotations are interpolated with interpolation, the positions
+// linearly, 4 bones at a time with SSE2. with parallel, the bones are
+// split between threads with openmp.
+MStatus resampleAnimation(const AnmData& in, int num_frames, AnmInterpolation interpolation,
+                          AnmData& out, bool parallel = true);
+
+// same, to fps frames per second : the frames are fps apart, from the
+// first frame to the last one that fits in the clip.
+MStatus resampleAnimationToFps(const AnmData& in, float fps, AnmInterpolation interpolation,
+                               AnmData& out, bool parallel = true);
+
+} // namespace riot
+
+#endif
@@ -0,0 +1,291 @@
+/*
+    Copyright 2011 Even Entem (alias ThiSpawn).
+
+    This file is part of Riot File Translator Plug-in for AutoDesk Maya.
+
+    Autodesk Maya's lib is under :
+    Copyright 1995, 2006, 2008 Autodesk, Inc. All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful, 
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <AnmSampler.h>
+
+#include <math.h>
+#include <vector>
+
+#include <AnmData.hpp>
+
+namespace riot {
+
+namespace {
+
+// hamilton product, x y z w. maya's a * b (a then b) is mul(b, a).
+void mul(const double* a, const double* b, double* out)
+{
+    double x = a[3] * b[0] + a[0] * b[3] + a[1] * b[2] - a[2] * b[1];
+    double y = a[3] * b[1] - a[0] * b[2] + a[1] * b[3] + a[2] * b[0];
+    double z = a[3] * b[2] + a[0] * b[1] - a[1] * b[0] + a[2] * b[3];
+    double w = a[3] * b[3] - a[0] * b[0] - a[1] * b[1] - a[2] * b[2];
+    out[0] = x;
+    out[1] = y;
+    out[2] = z;
+    out[3] = w;
+}
+
+// axes in the order they are applied, by rotate order
+const int kAxisOrder[6][3] = {
+    { 0, 1, 2 }, // xyz
+    { 1, 2, 0 }, // yzx
+    { 2, 0, 1 }, // zxy
+    { 0, 2, 1 }, // xzy
+    { 1, 0, 2 }, // yxz
+    { 2, 1, 0 }  // zyx
+};
+
+void eulerToQuaternion(const double* angles, int rotate_order, double* q)
+{
+    if (rotate_order < 0 || rotate_order > 5)
+        rotate_order = kRotateXYZ;
+
+    q[0] = 0.0;
+    q[1] = 0.0;
+    q[2] = 0.0;
+    q[3] = 1.0;
+    for (int i = 0; i < 3; i++)
+    {
+        int axis = kAxisOrder[rotate_order][i];
+        double half = 0.5 * angles[axis];
+        double axis_q[4] = { 0.0, 0.0, 0.0, cos(half) };
+        axis_q[axis] = sin(half);
+        // each axis is applied after the previous ones
+        mul(axis_q, q, q);
+    }
+}
+
+const double kPi = 3.14159265358979323846;
+
+void conjugate(const double* q, double* out)
+{
+    out[0] = -q[0];
+    out[1] = -q[1];
+    out[2] = -q[2];
+    out[3] = q[3];
+}
+
+// angles of a unit quaternion for a rotate order, in -pi .. pi
+void quaternionToEuler(const double* q, int rotate_order, double* angles)
+{
+    if (rotate_order < 0 || rotate_order > 5)
+        rotate_order = kRotateXYZ;
+
+    // the rotation matrix, for column vectors
+    double x = q[0], y = q[1], z = q[2], w = q[3];
+    double m[3][3] = {
+        { 1.0 - 2.0 * (y * y + z * z), 2.0 * (x * y - z * w), 2.0 * (x * z + y * w) },
+        { 2.0 * (x * y + z * w), 1.0 - 2.0 * (x * x + z * z), 2.0 * (y * z - x * w) },
+        { 2.0 * (x * z - y * w), 2.0 * (y * z + x * w), 1.0 - 2.0 * (x * x + y * y) }
+    };
+
+    // m = r(k) * r(j) * r(i), i applied first
+    int i = kAxisOrder[rotate_order][0];
+    int j = kAxisOrder[rotate_order][1];
+    int k = kAxisOrder[rotate_order][2];
+    double parity = (j == (i + 1) % 3) ? 1.0 : -1.0;
+
+    double cos_j = sqrt(m[i][i] * m[i][i] + m[j][i] * m[j][i]);
+    angles[j] = atan2(-parity * m[k][i], cos_j);
+    if (cos_j > 1e-6)
+    {
+        angles[i] = atan2(parity * m[k][j], m[k][k]);
+        angles[k] = atan2(parity * m[j][i], m[i][i]);
+    }
+    else // gimbal lock, all on the first axis
+    {
+        angles[i] = atan2(-parity * m[j][k], m[j][j]);
+        angles[k] = 0.0;
+    }
+}
+
+// closest to reference of angle + 2 pi n
+double wrapNear(double angle, double reference)
+{
+    return angle + 2.0 * kPi * floor((reference - angle) / (2.0 * kPi) + 0.5);
+}
+
+// of the two angle sets giving the same rotation, the closest to previous,
+// so the curves don't flip between frames
+void filterEuler(const double* previous, int rotate_order, double* angles)
+{
+    if (rotate_order < 0 || rotate_order > 5)
+        rotate_order = kRotateXYZ;
+    int i = kAxisOrder[rotate_order][0];
+    int j = kAxisOrder[rotate_order][1];
+    int k = kAxisOrder[rotate_order][2];
+
+    double flipped[3];
+    flipped[i] = angles[i] + kPi;
+    flipped[j] = kPi - angles[j];
+    flipped[k] = angles[k] + kPi;
+
+    double distance = 0.0;
+    double flipped_distance = 0.0;
+    for (int a = 0; a < 3; a++)
+    {
+        angles[a] = wrapNear(angles[a], previous[a]);
+        flipped[a] = wrapNear(flipped[a], previous[a]);
+        distance += fabs(angles[a] - previous[a]);
+        flipped_distance += fabs(flipped[a] - previous[a]);
+    }
+    if (flipped_distance < distance)
+    {
+        for (int a = 0; a < 3; a++)
+            angles[a] = flipped[a];
+    }
+}
+
+void composeJoint(const AnmJointSetup& setup, const double* values, int num_frames, AnmBone& bone)
+{
+    double rotate_axis[4];
+    double joint_orient[4];
+    for (int i = 0; i < 4; i++)
+    {
+        rotate_axis[i] = setup.rotate_axis[i];
+        joint_orient[i] = setup.joint_orient[i];
+    }
+
+    bone.poses.resize(num_frames);
+    for (int i = 0; i < num_frames; i++)
+    {
+        const double* channels = values + i * AnmCurveSource::kNumChannels;
+
+        // rotate axis * rotation * joint orient, in maya's order
+        double rotation[4];
+        eulerToQuaternion(channels + 3, setup.rotate_order, rotation);
+        double q[4];
+        mul(rotation, rotate_axis, q);
+        mul(joint_orient, q, q);
+
+        AnmPos& pos = bone.poses[i];
+        pos.rot[0] = static_cast<float>(q[0]);
+        pos.rot[1] = static_cast<float>(q[1]);
+        pos.rot[2] = static_cast<float>(q[2]);
+        pos.rot[3] = static_cast<float>(q[3]);
+        pos.x = static_cast<float>(channels[0]);
+        pos.y = static_cast<float>(channels[1]);
+        pos.z = static_cast<float>(channels[2]);
+    }
+}
+
+void extractJoint(const AnmJointSetup& setup, const AnmData& data, int bone, int num_frames, double* values)
+{
+    double inverse_axis[4];
+    double inverse_orient[4];
+    double rotate_axis[4];
+    double joint_orient[4];
+    for (int i = 0; i < 4; i++)
+    {
+        rotate_axis[i] = setup.rotate_axis[i];
+        joint_orient[i] = setup.joint_orient[i];
+    }
+    conjugate(rotate_axis, inverse_axis);
+    conjugate(joint_orient, inverse_orient);
+
+    for (int i = 0; i < num_frames; i++)
+    {
+        AnmPos pos;
+        data.getPose(bone, i, pos);
+        double* channels = values + i * AnmCurveSource::kNumChannels;
+        channels[0] = pos.x;
+        channels[1] = pos.y;
+        channels[2] = pos.z;
+
+        double q[4] = { pos.rot[0], pos.rot[1], pos.rot[2], pos.rot[3] };
+        double length = sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+        if (length > 0.0)
+        {
+            for (int c = 0; c < 4; c++)
+                q[c] /= length;
+        }
+        else
+        {
+            q[3] = 1.0;
+        }
+
+        // undo the rotate axis and the joint orient
+        mul(q, inverse_axis, q);
+        mul(inverse_orient, q, q);
+
+        quaternionToEuler(q, setup.rotate_order, channels + 3);
+        if (i > 0)
+            filterEuler(channels + 3 - AnmCurveSource::kNumChannels, setup.rotate_order, channels + 3);
+    }
+}
+
+} // namespace
+
+void sampleAnimation(AnmCurveSource& source, double start_time, int num_frames, AnmData& data)
+{
+    int num_joints = source.numJoints();
+    if (static_cast<int>(data.bones.size()) < num_joints)
+        data.bones.resize(num_joints);
+    if (num_frames <= 0 || num_joints <= 0)
+        return;
+
+    std::vector<double> times(num_frames);
+    for (int i = 0; i < num_frames; i++)
+        times[i] = start_time + i;
+
+    std::vector<AnmJointSetup> setups(num_joints);
+    for (int j = 0; j < num_joints; j++)
+        source.getSetup(j, setups[j]);
+
+    const int values_per_joint = num_frames * AnmCurveSource::kNumChannels;
+    if (source.isThreadSafe())
+    {
+#pragma omp parallel
+        {
+            std::vector<double> values(values_per_joint);
+
+#pragma omp for schedule(dynamic)
+            for (int j = 0; j < num_joints; j++)
+            {
+                source.evaluate(j, &times[0], num_frames, &values[0]);
+                composeJoint(setups[j], &values[0], num_frames, data.bones[j]);
+            }
+        }
+    }
+    else
+    {
+        std::vector<double> values(static_cast<size_t>(num_joints) * values_per_joint);
+        for (int j = 0; j < num_joints; j++)
+            source.evaluate(j, &times[0], num_frames, &values[static_cast<size_t>(j) * values_per_joint]);
+
+#pragma omp parallel for schedule(dynamic)
+        for (int j = 0; j < num_joints; j++)
+            composeJoint(setups[j], &values[static_cast<size_t>(j) * values_per_joint], num_frames, data.bones[j]);
+    }
+}
+
+void extractChannels(const AnmData& data, const AnmJointSetup* setups, int num_frames, double* values)
+{
+    int num_joints = static_cast<int>(data.bones.size());
+    const int values_per_joint = num_frames * AnmCurveSource::kNumChannels;
+
+#pragma omp parallel for schedule(dynamic)
+    for (int j = 0; j < num_joints; j++)
+        extractJoint(setups[j], data, j, num_frames, &values[static_cast<size_t>(j) * values_per_joint]);
+}
+
+} // namespace riot
+
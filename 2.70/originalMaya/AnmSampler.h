@@ -0,0 +1,83 @@
+/*
+    Copyright 2011 Even Entem (alias ThiSpawn).
+
+    This file is part of Riot File Translator Plug-in for AutoDesk Maya.
+
+    Autodesk Maya's lib is under :
+    Copyright 1995, 2006, 2008 Autodesk, Inc. All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful, 
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef RIOT__ANMSAMPLER_H
+#define RIOT__ANMSAMPLER_H
+
+namespace riot {
+
+struct AnmData;
+
+// rotate orders, as the values of the rotateOrder attribute
+enum RotateOrder
+{
+    kRotateXYZ = 0,
+    kRotateYZX = 1,
+    kRotateZXY = 2,
+    kRotateXZY = 3,
+    kRotateYXZ = 4,
+    kRotateZYX = 5
+};
+
+// what doesn't move on a joint, quaternions are x y z w
+struct AnmJointSetup
+{
+    float rotate_axis[4]; // rotateAxis (the rotate orientation)
+    float joint_orient[4];
+    int rotate_order;
+};
+
+// where the joint animation is read from : the scene curves in maya,
+// or anything else (e.g. a synthetic source without maya).
+class AnmCurveSource
+{
+public:
+    // the channels evaluate() gives, in that order
+    static const int kNumChannels = 6; // translate x y z, rotate x y z (radians)
+
+    virtual ~AnmCurveSource() {}
+
+    virtual int numJoints() const = 0;
+    virtual void getSetup(int joint, AnmJointSetup& setup) const = 0;
+
+    // channels of a joint at each of the times, num_times * kNumChannels values
+    virtual void evaluate(int joint, const double* times, int num_times, double* values) = 0;
+
+    // true if evaluate() may run on several threads at once, else the
+    // channels are all evaluated first on the calling thread
+    virtual bool isThreadSafe() const = 0;
+};
+
+// fills the poses of data.bones (one per joint of the source) for the
+// num_frames frames from start_time, without moving the scene time.
+// local rotation = rotate axis, then rotation, then joint orient, as maya
+// composes them. the joints are split between threads with openmp.
+void sampleAnimation(AnmCurveSource& source, double start_time, int num_frames, AnmData& data);
+
+// the other way : the channels of the poses of each bone of data, laid out
+// as AnmCurveSource::evaluate() gives them, bone after bone.
+// the rotations are made continuous from a frame to the next, for the
+// curves to interpolate between the keys without flipping.
+void extractChannels(const AnmData& data, const AnmJointSetup* setups, int num_frames, double* values);
+
+} // namespace riot
+
+#endif
@@ -22,6 +22,9 @@
 
 #include <AnmWriter.h>
 
+#include <math.h>
+#include <string.h>
+
 #include <maya/MGlobal.h>
 #include <maya/MFnIkJoint.h>
 #include <maya/MTransformationMatrix.h>
@@ -33,12 +36,123 @@
 #include <maya/MItDag.h>
 
 #include <maya_misc.h>
+#include <AnmSampler.h>
+#ifndef RIOT_HEADLESS
+#include <AnmCurves.h>
+#endif
 
 namespace riot {
 
+namespace {
+
+// values of N floats, each one stored once.
+// the values are keyed by their bits, or with a tolerance by the cell of
+// a grid of that size they fall in, the first value of a cell stands for
+// the others. the keys are found back with an open addressing hash table.
+template <int N>
+class ValuePool
+{
+public:
+    explicit ValuePool(float tolerance)
+        : tolerance_(tolerance), mask_(0)
+    {
+        table_.assign(1024, -1);
+        mask_ = 1023;
+    }
+
+    // index of value in the pool
+    int add(const float* value)
+    {
+        long long key[N];
+        for (int i = 0; i < N; i++)
+        {
+            if (tolerance_ > 0.0f)
+            {
+                key[i] = static_cast<long long>(floor(value[i] / tolerance_));
+            }
+            else
+            {
+                unsigned int bits;
+                memcpy(&bits, value + i, 4);
+                key[i] = bits;
+            }
+        }
+
+        unsigned long long hash = 0;
+        for (int i = 0; i < N; i++)
+            hash = (hash ^ static_cast<unsigned long long>(key[i])) * 0x9E3779B97F4A7C15ULL;
+        int slot = static_cast<int>(hash >> 32) & mask_;
+        for (;;)
+        {
+            int index = table_[slot];
+            if (index < 0)
+                break;
+            if (!memcmp(&keys_[N * index], key, sizeof(key)))
+                return index;
+            slot = (slot + 1) & mask_;
+        }
+
+        int index = size();
+        keys_.insert(keys_.end(), key, key + N);
+        values_.insert(values_.end(), value, value + N);
+        table_[slot] = index;
+        if (2 * size() > mask_)
+            grow();
+        return index;
+    }
+
+    int size() const { return static_cast<int>(values_.size()) / N; }
+    const float* values() const { return values_.empty() ? 0 : &values_[0]; }
+
+private:
+    void grow()
+    {
+        table_.assign(2 * table_.size(), -1);
+        mask_ = static_cast<int>(table_.size()) - 1;
+        int num_values = size();
+        for (int index = 0; index < num_values; index++)
+        {
+            unsigned long long hash = 0;
+            for (int i = 0; i < N; i++)
+                hash = (hash ^ static_cast<unsigned long long>(keys_[N * index + i])) * 0x9E3779B97F4A7C15ULL;
+            int slot = static_cast<int>(hash >> 32) & mask_;
+            while (table_[slot] >= 0)
+                slot = (slot + 1) & mask_;
+            table_[slot] = index;
+        }
+    }
+
+    float tolerance_;
+    std::vector<long long> keys_;
+    std::vector<float> values_;
+    std::vector<int> table_;
+    int mask_;
+};
+
+// every bone has a pose for every frame, in the bones or packed
+bool hasAllPoses(const AnmData& data)
+{
+    if (data.num_bones < 0 || data.num_frames < 0 || static_cast<int>(data.bones.size()) < data.num_bones)
+        return false;
+    if (data.packed())
+        return data.pose_buffer.numBones() >= data.num_bones && data.pose_buffer.numFrames() >= data.num_frames;
+    for (int i = 0; i < data.num_bones; i++)
+    {
+        if (static_cast<int>(data.bones[i].poses.size()) < data.num_frames)
+            return false;
+    }
+    return true;
+}
+
+} // namespace
+
+template <class Hand>
 MStatus AnmWriter::write(ostream& file)
 {
-    data_.switchHand();
+    if (!hasAllPoses(data_))
+        FAILURE("AnmWriter: the counts don't match the data");
+    if (data_.version == 4)
+        return writeCompressed<Hand>(file);
 
     // set magic
     char magic[9] = "r3d2anmd";
@@ -67,11 +181,14 @@ MStatus AnmWriter::write(ostream& file)
     // set bones with frames
     for (int i = 0; i < num_bones; i++)
     {
-        AnmBone bone = data_.bones.at(i);
-        file.write(reinterpret_cast<char*>(&bone), AnmBone::kHeaderSize);
+        const AnmBone& bone = data_.bones.at(i);
+        file.write(reinterpret_cast<const char*>(&bone), AnmBone::kHeaderSize);
         for (int j = 0; j < num_frames; j++)
         {
-            AnmPos pos = bone.poses.at(j);
+            AnmPos pos;
+            data_.getPose(i, j, pos);
+            Hand::quaternion(pos.rot);
+            Hand::position(pos.x, pos.y, pos.z);
             file.write(reinterpret_cast<char*>(&pos), AnmPos::kSizeInFile);
         }
     }
@@ -79,6 +196,97 @@ MStatus AnmWriter::write(ostream& file)
     return MS::kSuccess;
 }
 
+template <class Hand>
+MStatus AnmWriter::writeCompressed(ostream& file)
+{
+    int num_bones = data_.num_bones;
+    int num_frames = data_.num_frames;
+
+    // the second id of an entry is a scale, always (1, 1, 1) here
+    ValuePool<3> positions(tolerance_);
+    ValuePool<4> quaternions(tolerance_);
+    const float unit_scale[3] = { 1.0f, 1.0f, 1.0f };
+    WORD scale_id = static_cast<WORD>(positions.add(unit_scale));
+
+    // entry : name hash (4), pos id (2), scale id (2), quat id (2), 0 (2)
+    const int kFrameEntrySize = 12;
+    std::vector<char> frames(static_cast<size_t>(num_frames) * num_bones * kFrameEntrySize);
+    std::vector<int> name_hashes(num_bones);
+    for (int j = 0; j < num_bones; j++)
+    {
+        const AnmBone& bone = data_.bones[j];
+        name_hashes[j] = bone.name_hash ? bone.name_hash : hashName(bone.name);
+    }
+
+    char* entry = frames.empty() ? 0 : &frames[0];
+    for (int i = 0; i < num_frames; i++)
+    {
+        for (int j = 0; j < num_bones; j++, entry += kFrameEntrySize)
+        {
+            AnmPos pos;
+            data_.getPose(j, i, pos);
+            Hand::quaternion(pos.rot);
+            Hand::position(pos.x, pos.y, pos.z);
+
+            int pos_id = positions.add(&pos.x);
+            int quat_id = quaternions.add(pos.rot);
+            if (pos_id > 0xFFFF || quat_id > 0xFFFF)
+                FAILURE("AnmWriter: v4, more than 65536 different positions or quaternions, raise the tolerance");
+
+            WORD ids[4] = { static_cast<WORD>(pos_id), scale_id, static_cast<WORD>(quat_id), 0 };
+            memcpy(entry, &name_hashes[j], 4);
+            memcpy(entry + 4, ids, 8);
+        }
+    }
+
+    const int kHeaderSize = 64; // from the data size on, the offsets start there
+    int num_pos = positions.size();
+    int num_quat = quaternions.size();
+    int positions_offset = kHeaderSize;
+    int quaternions_offset = positions_offset + num_pos * 12;
+    int frames_offset = quaternions_offset + num_quat * 16;
+    int data_size = frames_offset + static_cast<int>(frames.size());
+
+    char header[12 + kHeaderSize];
+    memset(header, 0, sizeof(header));
+    memcpy(header, "r3d2anmd", 8);
+    int version = 4;
+    memcpy(header + 8, &version, 4);
+    memcpy(header + 12, &data_size, 4);
+    unsigned int magic = 0xBE0794D3;
+    memcpy(header + 16, &magic, 4);
+    // 8 bytes unused
+    memcpy(header + 28, &num_bones, 4);
+    memcpy(header + 32, &num_frames, 4);
+    float frame_duration = data_.fps > 0.0f ? 1.0f / data_.fps : 0.0f;
+    memcpy(header + 36, &frame_duration, 4);
+    // 12 bytes unused
+    memcpy(header + 52, &positions_offset, 4);
+    memcpy(header + 56, &quaternions_offset, 4);
+    memcpy(header + 60, &frames_offset, 4);
+    // 12 bytes unused
+
+    file.write(header, sizeof(header));
+    file.write(reinterpret_cast<const char*>(positions.values()), num_pos * 12);
+    file.write(reinterpret_cast<const char*>(quaternions.values()), num_quat * 16);
+    if (!frames.empty())
+        file.write(&frames[0], frames.size());
+
+    int uncompressed_size = 28 + num_bones * (AnmBone::kHeaderSize + num_frames * AnmPos::kSizeInFile);
+    int compressed_size = 12 + data_size;
+    MGlobal::displayInfo(MString("AnmWriter: v4, ") + num_pos + " positions and " + num_quat +
+                         " quaternions for " + num_bones * num_frames + " poses, " +
+                         compressed_size + " bytes (v3 : " + uncompressed_size + ", ratio " +
+                         floor(100.0 * uncompressed_size / compressed_size + 0.5) / 100.0 + ")");
+
+    return MS::kSuccess;
+}
+
+template MStatus AnmWriter::write<SwitchHand>(ostream& file);
+template MStatus AnmWriter::write<KeepHand>(ostream& file);
+
+#ifndef RIOT_HEADLESS
+
 MStatus AnmWriter::dumpData()
 {
     data_.version = 3;
@@ -145,36 +353,15 @@ MStatus AnmWriter::dumpData()
         }
     }
 
-    int num_bones = data_.num_bones;
-    int num_frames = data_.num_frames;
-    for (int i = 0; i < num_frames; i++)
-    {
-        MGlobal::executeCommand(MString("currentTime ") + (i + start));
-
-        for (int j = 0; j < num_bones; j++)
-        {
-            AnmPos pos;
-            fn_joint.setObject(data_.joints[j]);
-            MQuaternion rotation, orient, axe;
-            fn_joint.getRotation(rotation, MSpace::kTransform);
-            fn_joint.getOrientation(orient);
-            axe = fn_joint.rotateOrientation(MSpace::kTransform);
-            rotation = axe * rotation * orient;
-            MVector vec;
-            vec = fn_joint.getTranslation(MSpace::kTransform);
-            pos.rot[0] = static_cast<float>(rotation.x);
-            pos.rot[1] = static_cast<float>(rotation.y);
-            pos.rot[2] = static_cast<float>(rotation.z);
-            pos.rot[3] = static_cast<float>(rotation.w);
-            pos.x = static_cast<float>(vec.x);
-            pos.y = static_cast<float>(vec.y);
-            pos.z = static_cast<float>(vec.z);
-            data_.bones[j].poses.push_back(pos);
-        }
-    }
+    // the curves are evaluated at each frame instead of moving the
+    // current time and letting the whole scene update.
+    MayaCurveSource source(data_.joints);
+    sampleAnimation(source, start, data_.num_frames, data_);
 
     return MS::kSuccess;
 }
 
+#endif // RIOT_HEADLESS
+
 } // namespace riot
 
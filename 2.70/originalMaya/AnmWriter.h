@@ -28,17 +28,31 @@
 #include <maya/MIOStream.h>
 
 #include <AnmData.hpp>
+#include <Handedness.hpp>
 
 namespace riot {
 
 class AnmWriter
 {
 public:
-    MStatus write(ostream& file);
+    AnmWriter() : tolerance_(0.0f) {}
+
+    // Hand is SwitchHand or KeepHand, see Handedness.hpp
+    // data_ is left untouched, so it can be written more than once.
+    // written as data_.version : 3 (a pose per bone per frame) or
+    // 4 (shared position / quaternion pools indexed by a frame table).
+    template <class Hand> MStatus write(ostream& file);
+    MStatus write(ostream& file) { return write<SwitchHand>(file); }
     MStatus dumpData();
-    
-private:
+
     AnmData data_;
+
+    // version 4 : values whose components are in the same cell of a grid
+    // of this size share their pool entry, 0 merges exact duplicates only.
+    float tolerance_;
+
+private:
+    template <class Hand> MStatus writeCompressed(ostream& file);
 };
 
 } // namespace riot
@@ -0,0 +1,737 @@
+/*
+    Copyright 2011 Even Entem (alias ThiSpawn).
+
+    This file is part of Riot File Translator Plug-in for AutoDesk Maya.
+
+    Autodesk Maya's lib is under :
+    Copyright 1995, 2006, 2008 Autodesk, Inc. All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful, 
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <AssetCache.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <algorithm>
+#include <vector>
+
+#include <maya/MGlobal.h>
+#include <maya/MString.h>
+#include <maya/MFStream.h>
+
+#include <SknReader.h>
+#include <SklReader.h>
+#include <AnmReader.h>
+#include <MappedFile.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <direct.h>
+#include <process.h>
+#include <sys/utime.h>
+#else
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <utime.h>
+#endif
+
+namespace riot {
+
+namespace {
+
+enum EntryKind
+{
+    kSknEntry = 1,
+    kSklEntry = 2,
+    kAnmEntry = 3
+};
+
+const char kEntryMagic[8] = { 'r', 'i', 'o', 't', 'c', 'a', 'c', 'h' };
+const char kEntryExtension[] = ".rcache";
+
+// the payload starts at kPayloadOffset, which keeps it aligned
+struct EntryHeader
+{
+    char magic[8];
+    int layout_version;
+    int kind;
+    unsigned long long content_hash;
+    long long source_size;
+    long long payload_size;
+};
+const int kPayloadOffset = 64;
+
+template <class Hand>
+struct HandTag;
+
+template <>
+struct HandTag<SwitchHand>
+{
+    static const int kValue = 1;
+};
+
+template <>
+struct HandTag<KeepHand>
+{
+    static const int kValue = 0;
+};
+
+// MurmurHash64A, by Austin Appleby (public domain)
+unsigned long long hashBytes(const char* data, int length, unsigned long long seed)
+{
+    const unsigned long long m = 0xc6a4a7935bd1e995ULL;
+    const int r = 47;
+
+    unsigned long long h = seed ^ (static_cast<unsigned long long>(length) * m);
+
+    int num_blocks = length / 8;
+    for (int i = 0; i < num_blocks; i++)
+    {
+        unsigned long long k;
+        memcpy(&k, data + 8 * i, 8);
+        k *= m;
+        k ^= k >> r;
+        k *= m;
+        h ^= k;
+        h *= m;
+    }
+
+    const unsigned char* tail = reinterpret_cast<const unsigned char*>(data + 8 * num_blocks);
+    switch (length & 7)
+    {
+    case 7: h ^= static_cast<unsigned long long>(tail[6]) << 48; // fall through
+    case 6: h ^= static_cast<unsigned long long>(tail[5]) << 40; // fall through
+    case 5: h ^= static_cast<unsigned long long>(tail[4]) << 32; // fall through
+    case 4: h ^= static_cast<unsigned long long>(tail[3]) << 24; // fall through
+    case 3: h ^= static_cast<unsigned long long>(tail[2]) << 16; // fall through
+    case 2: h ^= static_cast<unsigned long long>(tail[1]) << 8; // fall through
+    case 1: h ^= static_cast<unsigned long long>(tail[0]);
+            h *= m;
+    }
+
+    h ^= h >> r;
+    h *= m;
+    h ^= h >> r;
+    return h;
+}
+
+// what an entry is looked up with
+struct EntryKey
+{
+    int kind;
+    unsigned long long content_hash;
+    long long source_size;
+};
+
+bool makeKey(const char* file_name, int kind, int hand, EntryKey& key)
+{
+    MappedFile source;
+    if (!source.open(file_name))
+        return false;
+
+    key.kind = kind;
+    key.source_size = source.size();
+    unsigned long long seed = (static_cast<unsigned long long>(AssetCache::kLayoutVersion) << 16) |
+                              (kind << 8) | hand;
+    key.content_hash = hashBytes(source.data(), source.size(), seed);
+    return true;
+}
+
+std::string entryPath(const std::string& directory, const EntryKey& key)
+{
+    static const char* kEntryNames[] = { "", "skn", "skl", "anm" };
+    char hex[17];
+    for (int i = 0; i < 16; i++)
+        hex[i] = "0123456789abcdef"[(key.content_hash >> (60 - 4 * i)) & 0xF];
+    hex[16] = 0;
+    return directory + "/" + hex + "." + kEntryNames[key.kind] + kEntryExtension;
+}
+
+// payload being built, arrays are preceded by their count and aligned
+class Blob
+{
+public:
+    void put(const void* data, int size)
+    {
+        if (size <= 0)
+            return;
+        const char* bytes = reinterpret_cast<const char*>(data);
+        bytes_.insert(bytes_.end(), bytes, bytes + size);
+    }
+
+    template <class T>
+    void putValue(const T& value)
+    {
+        put(&value, sizeof(T));
+    }
+
+    template <class T>
+    void putArray(const T* data, int count)
+    {
+        putValue(count);
+        bytes_.resize((bytes_.size() + AssetCache::kAlignment - 1) & ~(AssetCache::kAlignment - 1));
+        put(data, count * static_cast<int>(sizeof(T)));
+    }
+
+    const std::vector<char>& bytes() const { return bytes_; }
+
+private:
+    std::vector<char> bytes_;
+};
+
+// reads a payload from a mapped entry, nothing is read past its end
+class BlobReader
+{
+public:
+    BlobReader(const char* data, int size)
+        : data_(data), size_(size), offset_(0), ok_(true)
+    {
+    }
+
+    bool ok() const { return ok_; }
+
+    void get(void* out, int size)
+    {
+        const char* p = take(size);
+        if (p)
+            memcpy(out, p, size);
+        else
+            memset(out, 0, size);
+    }
+
+    template <class T>
+    T getValue()
+    {
+        T value;
+        get(&value, sizeof(T));
+        return value;
+    }
+
+    // data points into the entry, 0 if the entry is broken
+    template <class T>
+    int getArray(const T*& data)
+    {
+        int count = getValue<int>();
+        int aligned = (offset_ + AssetCache::kAlignment - 1) & ~(AssetCache::kAlignment - 1);
+        if (!ok_ || count < 0 || aligned > size_ ||
+            count > (size_ - aligned) / static_cast<int>(sizeof(T)))
+        {
+            ok_ = false;
+            data = 0;
+            return 0;
+        }
+        offset_ = aligned;
+        data = reinterpret_cast<const T*>(take(count * static_cast<int>(sizeof(T))));
+        return count;
+    }
+
+    template <class T>
+    void getAlignedArray(AlignedArray<T>& out)
+    {
+        const T* data;
+        int count = getArray(data);
+        out.resize(count);
+        if (count)
+            memcpy(out.data(), data, count * sizeof(T));
+    }
+
+private:
+    const char* take(int size)
+    {
+        if (!ok_ || size < 0 || size > size_ - offset_)
+        {
+            ok_ = false;
+            return 0;
+        }
+        const char* p = data_ + offset_;
+        offset_ += size;
+        return p;
+    }
+
+    const char* data_;
+    int size_;
+    int offset_;
+    bool ok_;
+};
+
+// skn
+
+void save(Blob& blob, const SknData& data)
+{
+    blob.putValue(static_cast<int>(data.version));
+    blob.putValue(data.num_vtxs);
+    blob.putValue(data.num_indices);
+    blob.putValue(data.num_final_vtxs);
+    blob.put(data.endTab, sizeof(data.endTab));
+    blob.putArray(data.materials.empty() ? 0 : &data.materials[0], static_cast<int>(data.materials.size()));
+    blob.putArray(data.index_view, data.index_view ? data.num_indices : 0);
+    const SknVertexStreams& vertices = data.vertices;
+    blob.putArray(vertices.positions.data(), vertices.positions.size());
+    blob.putArray(vertices.normals.data(), vertices.normals.size());
+    blob.putArray(vertices.u.data(), vertices.u.size());
+    blob.putArray(vertices.v.data(), vertices.v.size());
+    blob.putArray(vertices.skn_indices.data(), vertices.skn_indices.size());
+    blob.putArray(vertices.weights.data(), vertices.weights.size());
+}
+
+bool load(BlobReader& blob, SknData& data)
+{
+    data.version = static_cast<short>(blob.getValue<int>());
+    data.num_vtxs = blob.getValue<int>();
+    data.num_indices = blob.getValue<int>();
+    data.num_final_vtxs = blob.getValue<int>();
+    blob.get(data.endTab, sizeof(data.endTab));
+
+    const SknMaterial* materials;
+    int num_materials = blob.getArray(materials);
+    data.materials.assign(materials, materials + num_materials);
+
+    const USHORT* indices;
+    int num_indices = blob.getArray(indices);
+    data.indices.assign(indices, indices + num_indices);
+    data.index_view = 0;
+    data.ownIndices();
+
+    SknVertexStreams& vertices = data.vertices;
+    blob.getAlignedArray(vertices.positions);
+    blob.getAlignedArray(vertices.normals);
+    blob.getAlignedArray(vertices.u);
+    blob.getAlignedArray(vertices.v);
+    blob.getAlignedArray(vertices.skn_indices);
+    blob.getAlignedArray(vertices.weights);
+
+    int num_vertices = vertices.u.size();
+    return blob.ok() && num_indices == data.num_indices &&
+           vertices.positions.size() == 4 * num_vertices &&
+           vertices.normals.size() == 3 * num_vertices &&
+           vertices.v.size() == num_vertices &&
+           vertices.skn_indices.size() == 4 * num_vertices &&
+           vertices.weights.size() == 4 * num_vertices;
+}
+
+// skl
+
+void save(Blob& blob, const SklData& data)
+{
+    blob.putValue(data.version);
+    blob.putValue(data.num_bones);
+    blob.putValue(data.num_indices);
+    blob.putArray(data.bones.empty() ? 0 : &data.bones[0], static_cast<int>(data.bones.size()));
+    std::vector<int> skn_indices(data.skn_indices.length());
+    for (size_t i = 0; i < skn_indices.size(); i++)
+        skn_indices[i] = data.skn_indices[static_cast<unsigned int>(i)];
+    blob.putArray(skn_indices.empty() ? 0 : &skn_indices[0], static_cast<int>(skn_indices.size()));
+}
+
+bool load(BlobReader& blob, SklData& data)
+{
+    data.version = blob.getValue<int>();
+    data.num_bones = blob.getValue<int>();
+    data.num_indices = blob.getValue<int>();
+
+    const SklBone* bones;
+    int num_bones = blob.getArray(bones);
+    data.bones.assign(bones, bones + num_bones);
+
+    const int* skn_indices;
+    int num_skn_indices = blob.getArray(skn_indices);
+    data.skn_indices.clear();
+    for (int i = 0; i < num_skn_indices; i++)
+        data.skn_indices.append(skn_indices[i]);
+
+    return blob.ok();
+}
+
+// anm
+
+void save(Blob& blob, const AnmData& data)
+{
+    blob.putValue(data.version);
+    blob.putValue(data.num_bones);
+    blob.putValue(data.num_frames);
+    blob.putValue(data.fps);
+    blob.putValue(static_cast<int>(data.bones.size()));
+    std::vector<AnmPos> packed_poses;
+    for (size_t i = 0; i < data.bones.size(); i++)
+    {
+        const AnmBone& bone = data.bones[i];
+        blob.put(bone.name, AnmBone::kNameLen);
+        blob.putValue(bone.flag);
+        blob.putValue(bone.name_hash);
+
+        // the entries keep the poses by bone whatever the reader decoded to
+        const std::vector<AnmPos>* poses = &bone.poses;
+        if (data.packed())
+        {
+            AnmPoseView<const float> view = data.pose_buffer.bone(static_cast<int>(i));
+            packed_poses.resize(view.count);
+            for (int j = 0; j < view.count; j++)
+                view.get(j, packed_poses[j]);
+            poses = &packed_poses;
+        }
+        blob.putArray(poses->empty() ? 0 : &(*poses)[0], static_cast<int>(poses->size()));
+    }
+}
+
+bool load(BlobReader& blob, AnmData& data)
+{
+    data.version = blob.getValue<int>();
+    data.num_bones = blob.getValue<int>();
+    data.num_frames = blob.getValue<int>();
+    data.fps = blob.getValue<float>();
+
+    int num_bones = blob.getValue<int>();
+    if (num_bones < 0)
+        return false;
+    data.bones.clear();
+    for (int i = 0; i < num_bones && blob.ok(); i++)
+    {
+        AnmBone bone;
+        blob.get(bone.name, AnmBone::kNameLen);
+        bone.flag = blob.getValue<int>();
+        bone.name_hash = blob.getValue<int>();
+        const AnmPos* poses;
+        int num_poses = blob.getArray(poses);
+        bone.poses.assign(poses, poses + num_poses);
+        data.bones.push_back(bone);
+    }
+
+    return blob.ok();
+}
+
+// entries
+
+template <class Data>
+bool loadEntry(const std::string& path, const EntryKey& key, Data& data)
+{
+    MappedFile entry;
+    if (!entry.open(path.c_str()) || entry.size() < kPayloadOffset)
+        return false;
+
+    EntryHeader header;
+    memcpy(&header, entry.data(), sizeof(header));
+    if (memcmp(header.magic, kEntryMagic, sizeof(kEntryMagic)) ||
+        header.layout_version != AssetCache::kLayoutVersion ||
+        header.kind != key.kind ||
+        header.content_hash != key.content_hash ||
+        header.source_size != key.source_size ||
+        header.payload_size != entry.size() - kPayloadOffset)
+        return false;
+
+    BlobReader blob(entry.data() + kPayloadOffset, entry.size() - kPayloadOffset);
+    return load(blob, data);
+}
+
+std::string decimal(int value)
+{
+    char digits[16];
+    int i = sizeof(digits);
+    digits[--i] = 0;
+    unsigned int u = static_cast<unsigned int>(value);
+    do
+    {
+        digits[--i] = static_cast<char>('0' + u % 10);
+        u /= 10;
+    } while (u);
+    return std::string(digits + i);
+}
+
+template <class Data>
+bool storeEntry(const std::string& path, const EntryKey& key, const Data& data)
+{
+    Blob blob;
+    save(blob, data);
+    const std::vector<char>& payload = blob.bytes();
+
+    char head[kPayloadOffset];
+    memset(head, 0, kPayloadOffset);
+    EntryHeader header;
+    memcpy(header.magic, kEntryMagic, sizeof(kEntryMagic));
+    header.layout_version = AssetCache::kLayoutVersion;
+    header.kind = key.kind;
+    header.content_hash = key.content_hash;
+    header.source_size = key.source_size;
+    header.payload_size = static_cast<long long>(payload.size());
+    memcpy(head, &header, sizeof(header));
+
+    // written aside then renamed, so another maya never maps half an entry
+#if defined(_WIN32)
+    int pid = _getpid();
+#else
+    int pid = static_cast<int>(getpid());
+#endif
+    std::string temp_path = path + "." + decimal(pid) + ".tmp";
+    {
+        ofstream file(temp_path.c_str(), ios::out | ios::binary);
+        file.write(head, kPayloadOffset);
+        if (!payload.empty())
+            file.write(&payload[0], payload.size());
+        if (!file)
+        {
+            file.close();
+            remove(temp_path.c_str());
+            return false;
+        }
+    }
+
+#if defined(_WIN32)
+    bool renamed = MoveFileExA(temp_path.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    bool renamed = rename(temp_path.c_str(), path.c_str()) == 0;
+#endif
+    if (!renamed)
+        remove(temp_path.c_str());
+    return renamed;
+}
+
+// the last write time is the last use time, see evict()
+void touch(const std::string& path)
+{
+#if defined(_WIN32)
+    _utime(path.c_str(), 0);
+#else
+    utime(path.c_str(), 0);
+#endif
+}
+
+struct EntryFile
+{
+    std::string path;
+    long long size;
+    long long last_use;
+
+    bool operator<(const EntryFile& other) const { return last_use < other.last_use; }
+};
+
+bool hasEntryExtension(const char* name)
+{
+    size_t length = strlen(name);
+    size_t extension_length = sizeof(kEntryExtension) - 1;
+    return length > extension_length && !strcmp(name + length - extension_length, kEntryExtension);
+}
+
+void listEntries(const std::string& directory, std::vector<EntryFile>& entries)
+{
+#if defined(_WIN32)
+    WIN32_FIND_DATAA find_data;
+    std::string pattern = directory + "/*" + kEntryExtension;
+    HANDLE find = FindFirstFileA(pattern.c_str(), &find_data);
+    if (find == INVALID_HANDLE_VALUE)
+        return;
+    do
+    {
+        if ((find_data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) || !hasEntryExtension(find_data.cFileName))
+            continue;
+        EntryFile entry;
+        entry.path = directory + "/" + find_data.cFileName;
+        entry.size = (static_cast<long long>(find_data.nFileSizeHigh) << 32) | find_data.nFileSizeLow;
+        entry.last_use = (static_cast<long long>(find_data.ftLastWriteTime.dwHighDateTime) << 32) |
+                         find_data.ftLastWriteTime.dwLowDateTime;
+        entries.push_back(entry);
+    } while (FindNextFileA(find, &find_data));
+    FindClose(find);
+#else
+    DIR* dir = opendir(directory.c_str());
+    if (!dir)
+        return;
+    while (struct dirent* dir_entry = readdir(dir))
+    {
+        if (!hasEntryExtension(dir_entry->d_name))
+            continue;
+        EntryFile entry;
+        entry.path = directory + "/" + dir_entry->d_name;
+        struct stat info;
+        if (stat(entry.path.c_str(), &info) != 0 || !S_ISREG(info.st_mode))
+            continue;
+        entry.size = static_cast<long long>(info.st_size);
+        entry.last_use = static_cast<long long>(info.st_mtime);
+        entries.push_back(entry);
+    }
+    closedir(dir);
+#endif
+}
+
+void makeDirectory(const std::string& directory)
+{
+#if defined(_WIN32)
+    _mkdir(directory.c_str());
+#else
+    mkdir(directory.c_str(), 0777);
+#endif
+}
+
+void report(const char* what, const char* file_name, const AssetCache::Stats& stats)
+{
+    MGlobal::displayInfo(MString("AssetCache: ") + what + " " + file_name +
+                         " (" + stats.hits + " hit(s), " + stats.misses + " miss(es))");
+}
+
+} // namespace
+
+AssetCache& AssetCache::importCache()
+{
+    static AssetCache cache;
+    static bool configured = false;
+    if (!configured)
+    {
+        configured = true;
+        const char* directory = getenv("RIOT_ASSET_CACHE");
+        if (directory)
+            cache.setDirectory(directory);
+        const char* max_megabytes = getenv("RIOT_ASSET_CACHE_MB");
+        if (max_megabytes && atoi(max_megabytes) > 0)
+            cache.setMaxBytes(static_cast<long long>(atoi(max_megabytes)) << 20);
+    }
+    return cache;
+}
+
+AssetCache::AssetCache()
+    : max_bytes_(1024LL << 20)
+{
+}
+
+void AssetCache::setDirectory(const std::string& directory)
+{
+    directory_ = directory;
+    while (directory_.size() > 1 && (directory_[directory_.size() - 1] == '/' || directory_[directory_.size() - 1] == '\\'))
+        directory_.erase(directory_.size() - 1);
+    if (!directory_.empty())
+        makeDirectory(directory_);
+}
+
+void AssetCache::setMaxBytes(long long max_bytes)
+{
+    max_bytes_ = max_bytes;
+}
+
+void AssetCache::evict()
+{
+    std::vector<EntryFile> entries;
+    listEntries(directory_, entries);
+
+    long long total = 0;
+    for (size_t i = 0; i < entries.size(); i++)
+        total += entries[i].size;
+    if (total <= max_bytes_)
+        return;
+
+    std::sort(entries.begin(), entries.end());
+    for (size_t i = 0; i < entries.size() && total > max_bytes_; i++)
+    {
+        if (remove(entries[i].path.c_str()) == 0)
+        {
+            total -= entries[i].size;
+            stats_.evictions++;
+        }
+    }
+}
+
+template <class Hand>
+MStatus AssetCache::read(SknReader& reader, const char* file_name)
+{
+    EntryKey key;
+    if (!enabled() || !makeKey(file_name, kSknEntry, HandTag<Hand>::kValue, key))
+        return reader.read<Hand>(file_name);
+
+    std::string path = entryPath(directory_, key);
+    if (loadEntry(path, key, reader.data_))
+    {
+        touch(path);
+        stats_.hits++;
+        report("hit", file_name, stats_);
+        return MS::kSuccess;
+    }
+    reader.data_ = SknData(); // a broken entry may have been partly loaded
+
+    stats_.misses++;
+    MStatus status = reader.read<Hand>(file_name);
+    if (status == MS::kSuccess && storeEntry(path, key, reader.data_))
+    {
+        stats_.stores++;
+        evict();
+    }
+    report("miss", file_name, stats_);
+    return status;
+}
+
+template <class Hand>
+MStatus AssetCache::read(SklReader& reader, istream& file, const char* file_name)
+{
+    EntryKey key;
+    if (!enabled() || !makeKey(file_name, kSklEntry, HandTag<Hand>::kValue, key))
+        return reader.read<Hand>(file);
+
+    std::string path = entryPath(directory_, key);
+    if (loadEntry(path, key, reader.data_))
+    {
+        touch(path);
+        stats_.hits++;
+        report("hit", file_name, stats_);
+        return MS::kSuccess;
+    }
+    reader.data_ = SklData(); // a broken entry may have been partly loaded
+
+    stats_.misses++;
+    MStatus status = reader.read<Hand>(file);
+    if (status == MS::kSuccess && storeEntry(path, key, reader.data_))
+    {
+        stats_.stores++;
+        evict();
+    }
+    report("miss", file_name, stats_);
+    return status;
+}
+
+template <class Hand>
+MStatus AssetCache::read(AnmReader& reader, istream& file, const char* file_name)
+{
+    EntryKey key;
+    if (!enabled() || !makeKey(file_name, kAnmEntry, HandTag<Hand>::kValue, key))
+        return reader.read<Hand>(file);
+
+    std::string path = entryPath(directory_, key);
+    if (loadEntry(path, key, reader.data_))
+    {
+        if (reader.packed_)
+            reader.data_.packPoses();
+        touch(path);
+        stats_.hits++;
+        report("hit", file_name, stats_);
+        return MS::kSuccess;
+    }
+    reader.data_ = AnmData(); // a broken entry may have been partly loaded
+
+    stats_.misses++;
+    MStatus status = reader.read<Hand>(file);
+    if (status == MS::kSuccess && storeEntry(path, key, reader.data_))
+    {
+        stats_.stores++;
+        evict();
+    }
+    report("miss", file_name, stats_);
+    return status;
+}
+
+template MStatus AssetCache::read<SwitchHand>(SknReader& reader, const char* file_name);
+template MStatus AssetCache::read<KeepHand>(SknReader& reader, const char* file_name);
+template MStatus AssetCache::read<SwitchHand>(SklReader& reader, istream& file, const char* file_name);
+template MStatus AssetCache::read<KeepHand>(SklReader& reader, istream& file, const char* file_name);
+template MStatus AssetCache::read<SwitchHand>(AnmReader& reader, istream& file, const char* file_name);
+template MStatus AssetCache::read<KeepHand>(AnmReader& reader, istream& file, const char* file_name);
+
+} // namespace riot
+
@@ -0,0 +1,104 @@
+/*
+    Copyright 2011 Even Entem (alias ThiSpawn).
+
+    This file is part of Riot File Translator Plug-in for AutoDesk Maya.
+
+    Autodesk Maya's lib is under :
+    Copyright 1995, 2006, 2008 Autodesk, Inc. All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful, 
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef RIOT__ASSETCACHE_H
+#define RIOT__ASSETCACHE_H
+
+#include <string>
+
+#include <maya/MStatus.h>
+#include <maya/MIOStream.h>
+
+#include <Handedness.hpp>
+
+namespace riot {
+
+class SknReader;
+class SklReader;
+class AnmReader;
+
+// on disk cache of the decoded skn / skl / anm data.
+// the key is a hash of the file content (and of the handedness), so an edited
+// file is a miss and a copied one a hit. an entry is a header followed by the
+// arrays as they are in memory, each aligned on kAlignment, so a hit is mapped
+// and copied into the reader without any parsing.
+// the least recently used entries are removed when the cache gets too big.
+// not thread safe, one cache is used by the importers on the main thread.
+class AssetCache
+{
+public:
+    static const int kLayoutVersion = 1; // change it with the data structs
+    static const int kAlignment = 16;
+
+    struct Stats
+    {
+        Stats() : hits(0), misses(0), stores(0), evictions(0) {}
+
+        int hits;
+        int misses;
+        int stores; // misses which could be stored
+        int evictions;
+    };
+
+    // the one the importers use, set from the environment :
+    // RIOT_ASSET_CACHE is the directory (no cache if it isn't set),
+    // RIOT_ASSET_CACHE_MB the size limit (1024 by default).
+    static AssetCache& importCache();
+
+    AssetCache();
+
+    // an empty directory disables the cache
+    void setDirectory(const std::string& directory);
+    void setMaxBytes(long long max_bytes);
+
+    bool enabled() const { return !directory_.empty(); }
+    const Stats& stats() const { return stats_; }
+
+    // fill reader.data_ from the cache, or with reader.read() which is then stored.
+    // file is what reader.read() gets, file_name is used for the hash.
+    template <class Hand> MStatus read(SknReader& reader, const char* file_name);
+    template <class Hand> MStatus read(SklReader& reader, istream& file, const char* file_name);
+    template <class Hand> MStatus read(AnmReader& reader, istream& file, const char* file_name);
+    MStatus read(SknReader& reader, const char* file_name)
+    {
+        return read<SwitchHand>(reader, file_name);
+    }
+    MStatus read(SklReader& reader, istream& file, const char* file_name)
+    {
+        return read<SwitchHand>(reader, file, file_name);
+    }
+    MStatus read(AnmReader& reader, istream& file, const char* file_name)
+    {
+        return read<SwitchHand>(reader, file, file_name);
+    }
+
+private:
+    // removes the oldest entries until the cache fits in max_bytes_
+    void evict();
+
+    std::string directory_;
+    long long max_bytes_;
+    Stats stats_;
+};
+
+} // namespace riot
+
+#endif
@@ -0,0 +1,44 @@
+/*
+    Copyright 2011 Even Entem (alias ThiSpawn).
+
+    This file is part of Riot File Translator Plug-in for AutoDesk Maya.
+
+    Autodesk Maya's lib is under :
+    Copyright 1995, 2006, 2008 Autodesk, Inc. All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful, 
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <BoneIndexMap.h>
+
+namespace riot {
+
+void BoneIndexMap::build(const MDagPathArray& joints)
+{
+    by_path_.clear();
+
+    num_joints_ = static_cast<int>(joints.length());
+    for (int i = 0; i < num_joints_; i++)
+    {
+        // the first one wins, as the linear searches did
+        by_path_.insert(std::make_pair(std::string(joints[i].fullPathName().asChar()), i));
+    }
+}
+
+int BoneIndexMap::find(const MDagPath& path) const
+{
+    std::map<std::string, int>::const_iterator found = by_path_.find(path.fullPathName().asChar());
+    return found != by_path_.end() ? found->second : -1;
+}
+
+} // namespace riot
@@ -0,0 +1,57 @@
+/*
+    Copyright 2011 Even Entem (alias ThiSpawn).
+
+    This file is part of Riot File Translator Plug-in for AutoDesk Maya.
+
+    Autodesk Maya's lib is under :
+    Copyright 1995, 2006, 2008 Autodesk, Inc. All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful, 
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef RIOT__BONEINDEXMAP_H
+#define RIOT__BONEINDEXMAP_H
+
+#include <map>
+#include <string>
+
+#include <maya/MDagPath.h>
+#include <maya/MDagPathArray.h>
+
+namespace riot {
+
+// the indices of a list of joints (the joints of a skeleton, the influences
+// of a skin cluster) by full dag path.
+// built once per import / export, so every influence finds its bone in a
+// map instead of being compared with each joint of the list.
+class BoneIndexMap
+{
+public:
+    BoneIndexMap() : num_joints_(0) {}
+    explicit BoneIndexMap(const MDagPathArray& joints) : num_joints_(0) { build(joints); }
+
+    void build(const MDagPathArray& joints);
+
+    // index of the joint or -1
+    int find(const MDagPath& path) const;
+
+    int numJoints() const { return num_joints_; }
+
+private:
+    int num_joints_;
+    std::map<std::string, int> by_path_;
+};
+
+} // namespace riot
+
+#endif
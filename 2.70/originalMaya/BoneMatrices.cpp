@@ -0,0 +1,217 @@
+/*
+    Copyright 2011 Even Entem (alias ThiSpawn).
+
+    This file is part of Riot File Translator Plug-in for AutoDesk Maya.
+
+    Autodesk Maya's lib is under :
+    Copyright 1995, 2006, 2008 Autodesk, Inc. All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful, 
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <BoneMatrices.h>
+
+#include <math.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RIOT_BONE_MATRICES_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace riot {
+
+namespace {
+
+inline const float* advance(const float* p, int bytes)
+{
+    return reinterpret_cast<const float*>(reinterpret_cast<const char*>(p) + bytes);
+}
+
+inline float* advance(float* p, int bytes)
+{
+    return reinterpret_cast<float*>(reinterpret_cast<char*>(p) + bytes);
+}
+
+void boneToMatrix(const float* q, const float* t, float* m)
+{
+    float length = sqrtf(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+    if (length == 0.0f)
+        length = 1.0f;
+    float x = q[0] / length;
+    float y = q[1] / length;
+    float z = q[2] / length;
+    float w = q[3] / length;
+
+    m[0] = 1.0f - 2.0f * (y * y + z * z);
+    m[1] = 2.0f * (x * y + z * w);
+    m[2] = 2.0f * (x * z - y * w);
+    m[3] = 0.0f;
+    m[4] = 2.0f * (x * y - z * w);
+    m[5] = 1.0f - 2.0f * (x * x + z * z);
+    m[6] = 2.0f * (y * z + x * w);
+    m[7] = 0.0f;
+    m[8] = 2.0f * (x * z + y * w);
+    m[9] = 2.0f * (y * z - x * w);
+    m[10] = 1.0f - 2.0f * (x * x + y * y);
+    m[11] = 0.0f;
+    m[12] = t[0];
+    m[13] = t[1];
+    m[14] = t[2];
+    m[15] = 1.0f;
+}
+
+} // namespace
+
+// four bones at once : the quaternions are transposed to x y z w of the
+// four, and the rows of the four matrices transposed back
+template <class Hand>
+void bonesToMatrices(const float* quaternions, const float* translations, int source_stride,
+                     int count, float* matrices, int matrix_stride)
+{
+    int i = 0;
+#if defined(RIOT_BONE_MATRICES_SSE2)
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 two = _mm_set1_ps(2.0f);
+
+    for (; i + 4 <= count; i += 4)
+    {
+        const float* q[4];
+        const float* t[4];
+        float* m[4];
+        for (int k = 0; k < 4; k++)
+        {
+            q[k] = advance(quaternions, (i + k) * source_stride);
+            t[k] = advance(translations, (i + k) * source_stride);
+            m[k] = advance(matrices, (i + k) * matrix_stride);
+        }
+
+        __m128 x = _mm_loadu_ps(q[0]);
+        __m128 y = _mm_loadu_ps(q[1]);
+        __m128 z = _mm_loadu_ps(q[2]);
+        __m128 w = _mm_loadu_ps(q[3]);
+        _MM_TRANSPOSE4_PS(x, y, z, w);
+
+        __m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)),
+                                               _mm_add_ps(_mm_mul_ps(z, z), _mm_mul_ps(w, w))));
+        __m128 null = _mm_cmpeq_ps(length, zero);
+        length = _mm_or_ps(_mm_andnot_ps(null, length), _mm_and_ps(null, one));
+        x = _mm_div_ps(x, length);
+        y = _mm_div_ps(y, length);
+        z = _mm_div_ps(z, length);
+        w = _mm_div_ps(w, length);
+
+        __m128 xx = _mm_mul_ps(x, x);
+        __m128 yy = _mm_mul_ps(y, y);
+        __m128 zz = _mm_mul_ps(z, z);
+        __m128 xy = _mm_mul_ps(x, y);
+        __m128 xz = _mm_mul_ps(x, z);
+        __m128 yz = _mm_mul_ps(y, z);
+        __m128 xw = _mm_mul_ps(x, w);
+        __m128 yw = _mm_mul_ps(y, w);
+        __m128 zw = _mm_mul_ps(z, w);
+
+        __m128 r0c0 = _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz)));
+        __m128 r0c1 = _mm_mul_ps(two, _mm_add_ps(xy, zw));
+        __m128 r0c2 = _mm_mul_ps(two, _mm_sub_ps(xz, yw));
+        __m128 r0c3 = zero;
+        _MM_TRANSPOSE4_PS(r0c0, r0c1, r0c2, r0c3);
+
+        __m128 r1c0 = _mm_mul_ps(two, _mm_sub_ps(xy, zw));
+        __m128 r1c1 = _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz)));
+        __m128 r1c2 = _mm_mul_ps(two, _mm_add_ps(yz, xw));
+        __m128 r1c3 = zero;
+        _MM_TRANSPOSE4_PS(r1c0, r1c1, r1c2, r1c3);
+
+        __m128 r2c0 = _mm_mul_ps(two, _mm_add_ps(xz, yw));
+        __m128 r2c1 = _mm_mul_ps(two, _mm_sub_ps(yz, xw));
+        __m128 r2c2 = _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy)));
+        __m128 r2c3 = zero;
+        _MM_TRANSPOSE4_PS(r2c0, r2c1, r2c2, r2c3);
+
+        // after the transposes, rK cJ holds row K of bone J
+        __m128 rows[4][3] = {
+            { r0c0, r1c0, r2c0 },
+            { r0c1, r1c1, r2c1 },
+            { r0c2, r1c2, r2c2 },
+            { r0c3, r1c3, r2c3 }
+        };
+        for (int k = 0; k < 4; k++)
+        {
+            _mm_storeu_ps(m[k], rows[k][0]);
+            _mm_storeu_ps(m[k] + 4, rows[k][1]);
+            _mm_storeu_ps(m[k] + 8, rows[k][2]);
+            _mm_storeu_ps(m[k] + 12, _mm_set_ps(1.0f, t[k][2], t[k][1], t[k][0]));
+            Hand::matrix(reinterpret_cast<float(*)[4]>(m[k]));
+        }
+    }
+#endif
+    for (; i < count; i++)
+    {
+        float* m = advance(matrices, i * matrix_stride);
+        boneToMatrix(advance(quaternions, i * source_stride), advance(translations, i * source_stride), m);
+        Hand::matrix(reinterpret_cast<float(*)[4]>(m));
+    }
+}
+
+template void bonesToMatrices<SwitchHand>(const float* quaternions, const float* translations, int source_stride,
+                                          int count, float* matrices, int matrix_stride);
+template void bonesToMatrices<KeepHand>(const float* quaternions, const float* translations, int source_stride,
+                                        int count, float* matrices, int matrix_stride);
+
+void multiplyMatrices(const float* a, const float* b, float* out)
+{
+#if defined(RIOT_BONE_MATRICES_SSE2)
+    __m128 b0 = _mm_loadu_ps(b);
+    __m128 b1 = _mm_loadu_ps(b + 4);
+    __m128 b2 = _mm_loadu_ps(b + 8);
+    __m128 b3 = _mm_loadu_ps(b + 12);
+    for (int i = 0; i < 4; i++)
+    {
+        const float* row = a + 4 * i;
+        __m128 r = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(row[0]), b0), _mm_mul_ps(_mm_set1_ps(row[1]), b1)),
+                              _mm_add_ps(_mm_mul_ps(_mm_set1_ps(row[2]), b2), _mm_mul_ps(_mm_set1_ps(row[3]), b3)));
+        _mm_storeu_ps(out + 4 * i, r);
+    }
+#else
+    for (int i = 0; i < 4; i++)
+    {
+        for (int j = 0; j < 4; j++)
+        {
+            out[4 * i + j] = a[4 * i] * b[j] + a[4 * i + 1] * b[4 + j] +
+                             a[4 * i + 2] * b[8 + j] + a[4 * i + 3] * b[12 + j];
+        }
+    }
+#endif
+}
+
+void switchHandMatrices(float* matrices, int count, int matrix_stride)
+{
+    int i = 0;
+#if defined(RIOT_BONE_MATRICES_SSE2)
+    const __m128 flip0 = _mm_set_ps(0.0f, -0.0f, -0.0f, 0.0f);
+    const __m128 flip123 = _mm_set_ps(0.0f, 0.0f, 0.0f, -0.0f);
+    for (; i < count; i++)
+    {
+        float* m = advance(matrices, i * matrix_stride);
+        _mm_storeu_ps(m, _mm_xor_ps(_mm_loadu_ps(m), flip0));
+        _mm_storeu_ps(m + 4, _mm_xor_ps(_mm_loadu_ps(m + 4), flip123));
+        _mm_storeu_ps(m + 8, _mm_xor_ps(_mm_loadu_ps(m + 8), flip123));
+        _mm_storeu_ps(m + 12, _mm_xor_ps(_mm_loadu_ps(m + 12), flip123));
+    }
+#endif
+    for (; i < count; i++)
+        SwitchHand::matrix(reinterpret_cast<float(*)[4]>(advance(matrices, i * matrix_stride)));
+}
+
+} // namespace riot
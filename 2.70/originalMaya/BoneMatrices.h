@@ -0,0 +1,48 @@
+/*
+    Copyright 2011 Even Entem (alias ThiSpawn).
+
+    This file is part of Riot File Translator Plug-in for AutoDesk Maya.
+
+    Autodesk Maya's lib is under :
+    Copyright 1995, 2006, 2008 Autodesk, Inc. All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful, 
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef RIOT__BONEMATRICES_H
+#define RIOT__BONEMATRICES_H
+
+#include <Handedness.hpp>
+
+namespace riot {
+
+// the matrices of count bones from their rotation quaternions (x y z w,
+// normalized here, a null one is the identity) and translations, in maya
+// layout : rotation in the upper 3x3, translation on the last row, the
+// same matrices as MTransformationMatrix::asMatrix() in float.
+// the source records are source_stride bytes apart, the matrices
+// matrix_stride bytes apart, so the file records and SklBone are used in
+// place. Hand is applied to the bones as the readers do.
+template <class Hand>
+void bonesToMatrices(const float* quaternions, const float* translations, int source_stride,
+                     int count, float* matrices, int matrix_stride);
+
+// out = a * b for maya layout matrices (v * a * b), out is neither a nor b
+void multiplyMatrices(const float* a, const float* b, float* out);
+
+// SwitchHand::matrix() on count matrices, matrix_stride bytes apart
+void switchHandMatrices(float* matrices, int count, int matrix_stride);
+
+} // namespace riot
+
+#endif
@@ -34,6 +34,9 @@
 #include <maya/MVectorArray.h>
 
 #include <maya_misc.h>
+#include <AnmData.hpp>
+#include <AnmSampler.h>
+#include <AnmCurves.h>
 
 namespace riot {
 
@@ -109,63 +112,56 @@ MStatus FixAnimCmd::doIt(const MArgList& /*args*/)
 
     int num_joints = joints.length();
 
-    MString command("setKeyframe -breakdown 0 -hierarchy none -controlPoints 0 -shape 0\
-                        -at translateX -at translateY -at translateZ\
-                        -at rotateX -at rotateY -at rotateZ");
-
     int start, end;
     MGlobal::executeCommand("playbackOptions -q -animationStartTime", start);
     MGlobal::executeCommand("playbackOptions -q -animationEndTime", end);
     int num_frames = end - start + 1;
+    if (num_joints == 0 || num_frames <= 0)
+        return MS::kSuccess;
 
-    MGlobal::executeCommand(MString("currentTime ") + start);
+    // the rotate and translate attributes over the range, read from the
+    // curves without moving the time
+    MayaCurveSource source(joints, false);
+    AnmData data;
+    sampleAnimation(source, start, num_frames, data);
 
     for (int i = 0; i < num_joints; i++)
     {
-            fn_joint.setObject(joints[i]);
-            MQuaternion rotation;//, orient, axe;
-            fn_joint.getRotation(rotation, MSpace::kTransform);
-            //fn_joint.getOrientation(orient);
-            //axe = fn_joint.rotateOrientation(MSpace::kTransform);
-            //rotation = axe * rotation * orient;
-            MVector vec;
-            vec = fn_joint.getTranslation(MSpace::kTransform);
+            const AnmPos& pos = data.bones[i].poses[0];
+            MQuaternion rotation(pos.rot[0], pos.rot[1], pos.rot[2], pos.rot[3]);
+            MVector vec(pos.x, pos.y, pos.z);
 
             // the offset will be added to fix.
             quaternions[i] = quaternions[i] * rotation.inverse();
             vectors[i] = vectors[i] - vec;
     }
 
-    //rekeys all
-    for (int i = 0; i < num_frames; i++)
-    {
-        MGlobal::executeCommand(MString("currentTime ") + (i + start));
-        MGlobal::executeCommand(command);
-    }
-
-    for (int i = 0; i < num_frames; i++)
+    for (int j = 0; j < num_joints; j++)
     {
-        MGlobal::executeCommand(MString("currentTime ") + (i + start));
-
-        for (int j = 0; j < num_joints; j++)
+        for (int i = 0; i < num_frames; i++)
         {
-            fn_joint.setObject(joints[j]);
-            MQuaternion rotation;//, orient, axe;
-            fn_joint.getRotation(rotation, MSpace::kTransform);
-            //fn_joint.getOrientation(orient);
-            //axe = fn_joint.rotateOrientation(MSpace::kTransform);
-            //rotation = axe * rotation * orient;
-            MVector vec;
-            vec = fn_joint.getTranslation(MSpace::kTransform);
-
+            AnmPos& pos = data.bones[j].poses[i];
+            MQuaternion rotation(pos.rot[0], pos.rot[1], pos.rot[2], pos.rot[3]);
             rotation = quaternions[j] * rotation;
-            vec += vectors[j];
-
-            fn_joint.setRotation(rotation, MSpace::kTransform);
-            fn_joint.setTranslation(vec, MSpace::kTransform);
+            pos.rot[0] = static_cast<float>(rotation.x);
+            pos.rot[1] = static_cast<float>(rotation.y);
+            pos.rot[2] = static_cast<float>(rotation.z);
+            pos.rot[3] = static_cast<float>(rotation.w);
+            pos.x += static_cast<float>(vectors[j].x);
+            pos.y += static_cast<float>(vectors[j].y);
+            pos.z += static_cast<float>(vectors[j].z);
         }
     }
 
+    // rekeys all, one addKeys per curve
+    std::vector<AnmJointSetup> setups(num_joints);
+    for (int j = 0; j < num_joints; j++)
+        source.getSetup(j, setups[j]);
+    std::vector<double> values(static_cast<size_t>(num_joints) * num_frames * AnmCurveSource::kNumChannels);
+    extractChannels(data, &setups[0], num_frames, &values[0]);
+    if (keyChannels(joints, &values[0], start, num_frames) != MS::kSuccess)
+        FAILURE("fixAnimCmd: keyChannels()");
+
     MGlobal::displayInfo("Selected joints fixed !");
 
     return MS::kSuccess;
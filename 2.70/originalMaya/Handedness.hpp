@@ -0,0 +1,78 @@
+/*
+    Copyright 2011 Even Entem (alias ThiSpawn).
+
+    This file is part of Riot File Translator Plug-in for AutoDesk Maya.
+
+    Autodesk Maya's lib is under :
+    Copyright 1995, 2006, 2008 Autodesk, Inc. All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful, 
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef RIOT__HANDEDNESS_HPP
+#define RIOT__HANDEDNESS_HPP
+
+namespace riot {
+
+// the coordinate system conversion between the files and maya.
+// readers and writers take one of these as a template parameter and apply it
+// to each element while decoding / encoding, so nothing is swept twice.
+
+// files are mirrored along x compared to maya
+struct SwitchHand
+{
+    static void position(float& x, float& /*y*/, float& /*z*/)
+    {
+        x = -x;
+    }
+
+    static void normal(float& /*x*/, float& y, float& z)
+    {
+        y = -y;
+        z = -z;
+    }
+
+    // x y z w
+    static void quaternion(float* q)
+    {
+        q[1] = -q[1];
+        q[2] = -q[2];
+    }
+
+    /*
+    maya layout, rotation in the upper 3x3 and translation on the last row.
+    mirroring x is S * M * S with S = diag(-1, 1, 1, 1), the same as
+    switching the rotation quaternion to (x, -y, -z, w) and negating tx.
+    */
+    static void matrix(float m[4][4])
+    {
+        m[0][1] = -m[0][1];
+        m[0][2] = -m[0][2];
+        m[1][0] = -m[1][0];
+        m[2][0] = -m[2][0];
+        m[3][0] = -m[3][0];
+    }
+};
+
+// keeps the file coordinates, for tools that don't go through maya
+struct KeepHand
+{
+    static void position(float&, float&, float&) {}
+    static void normal(float&, float&, float&) {}
+    static void quaternion(float*) {}
+    static void matrix(float[4][4]) {}
+};
+
+} // namespace riot
+
+#endif
@@ -0,0 +1,144 @@
+/*
+    Copyright 2011 Even Entem (alias ThiSpawn).
+
+    This file is part of Riot File Translator Plug-in for AutoDesk Maya.
+
+    Autodesk Maya's lib is under :
+    Copyright 1995, 2006, 2008 Autodesk, Inc. All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful, 
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <ImportAnims.h>
+
+#include <string>
+#include <vector>
+
+#include <maya/MString.h>
+
+#include <maya_misc.h>
+#include <AnmBatch.h>
+#include <AnmReader.h>
+#include <JointIndex.h>
+
+namespace riot {
+
+namespace {
+
+// keys each clip after the one before
+class TimelineTarget : public AnmBatchTarget
+{
+public:
+    TimelineTarget(const std::vector<std::string>& file_names, int gap)
+        : file_names_(file_names), gap_(gap), next_frame_(0), fps_(0.0f)
+    {
+    }
+
+    MStatus apply(int index, AnmReader& reader)
+    {
+        int num_frames = reader.data_.num_frames;
+        if (reader.loadData(next_frame_, false) != MS::kSuccess)
+            FAILURE(MString("importAnims: ") + file_names_[index].c_str() + " : loadData() failed");
+
+        MGlobal::displayInfo(MString("importAnims: ") + file_names_[index].c_str() + " : frames " +
+                             next_frame_ + " to " + (next_frame_ + num_frames - 1));
+        if (fps_ <= 0.0f)
+            fps_ = reader.data_.fps;
+        next_frame_ += num_frames + gap_;
+        return MS::kSuccess;
+    }
+
+    void failed(int index)
+    {
+        MGlobal::displayWarning(MString("importAnims: ") + file_names_[index].c_str() + " : skipped");
+    }
+
+    // the last frame keyed, -1 before any clip
+    int lastFrame() const { return next_frame_ > 0 ? next_frame_ - gap_ - 1 : -1; }
+    float fps() const { return fps_; }
+
+private:
+    const std::vector<std::string>& file_names_;
+    int gap_;
+    int next_frame_;
+    float fps_;
+};
+
+} // namespace
+
+void* ImportAnimsCmd::creator()
+{
+    return new ImportAnimsCmd();
+}
+
+MStatus ImportAnimsCmd::doIt(const MArgList& args)
+{
+    long long budget = 512; // megabytes
+    int gap = 10;
+    std::vector<std::string> file_names;
+
+    int num_args = static_cast<int>(args.length());
+    for (int i = 0; i < num_args; i++)
+    {
+        MString string;
+        args.get(i, string);
+        if (string == "-budget" && i + 1 < num_args)
+        {
+            args.get(++i, string);
+            budget = string.asUnsigned();
+        }
+        else if (string == "-gap" && i + 1 < num_args)
+        {
+            args.get(++i, string);
+            gap = string.asUnsigned();
+        }
+        else
+        {
+            file_names.push_back(string.asChar());
+        }
+    }
+    if (file_names.empty())
+        FAILURE("importAnims: no file given");
+
+    // one rebuild of the joint index at most for the whole library
+    JointIndex::sessionIndex().beginLookups();
+
+    TimelineTarget target(file_names, gap);
+    AnmBatchStats stats;
+    if (readAnimations(file_names, budget * 1024 * 1024, target, stats) != MS::kSuccess)
+        FAILURE("importAnims: readAnimations() failed");
+
+    if (target.lastFrame() >= 0)
+    {
+        MString playback_options("playbackOptions -e");
+        playback_options += " -min ";
+        playback_options += 0;
+        playback_options += " -max ";
+        playback_options += target.lastFrame();
+        playback_options += " -animationStartTime ";
+        playback_options += 0;
+        playback_options += " -animationEndTime ";
+        playback_options += target.lastFrame();
+        playback_options += " -playbackSpeed ";
+        playback_options += (target.fps() / 24.0f);
+
+        MGlobal::executeCommand(playback_options);
+    }
+
+    MGlobal::displayInfo(MString("importAnims: ") + stats.num_clips + " clips imported, " + stats.num_failed +
+                         " skipped, decoded in " + stats.num_waves + " waves of at most " +
+                         static_cast<int>(stats.peak_bytes / 1024) + " KB");
+    return MS::kSuccess;
+}
+
+} // namespace riot
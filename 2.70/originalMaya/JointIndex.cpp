@@ -0,0 +1,171 @@
+/*
+    Copyright 2011 Even Entem (alias ThiSpawn).
+
+    This file is part of Riot File Translator Plug-in for AutoDesk Maya.
+
+    Autodesk Maya's lib is under :
+    Copyright 1995, 2006, 2008 Autodesk, Inc. All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful, 
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <JointIndex.h>
+
+#include <ctype.h>
+
+#include <maya/MGlobal.h>
+#include <maya/MFnDagNode.h>
+#include <maya/MItDag.h>
+
+#include <maya_misc.h>
+
+namespace riot {
+
+namespace {
+
+std::string toLower(const std::string& name)
+{
+    std::string lower(name);
+    for (size_t i = 0; i < lower.size(); i++)
+        lower[i] = static_cast<char>(tolower(static_cast<unsigned char>(lower[i])));
+    return lower;
+}
+
+} // namespace
+
+JointIndex& JointIndex::sessionIndex()
+{
+    static JointIndex index;
+    return index;
+}
+
+JointIndex::JointIndex()
+    : built_(false), rebuilt_(false)
+{
+}
+
+MStatus JointIndex::build()
+{
+    paths_.clear();
+    names_.clear();
+    by_name_.clear();
+    by_lower_name_.clear();
+    by_hash_.clear();
+    built_ = false;
+
+    MStatus status;
+    MItDag it_dag(MItDag::kDepthFirst, MFn::kJoint, &status);
+    if (status != MStatus::kSuccess)
+        FAILURE("JointIndex: MItDag::MItDag()");
+
+    MDagPath dag_path;
+    for (; !it_dag.isDone(); it_dag.next())
+    {
+        it_dag.getPath(dag_path);
+        MFnDagNode fn_node(dag_path);
+        std::string name(fn_node.name().asChar());
+
+        int index = static_cast<int>(paths_.size());
+        paths_.push_back(dag_path);
+        names_.push_back(name);
+
+        // the first one in depth first order wins, as the dag searches did
+        std::map<std::string, int>::iterator found = by_name_.find(name);
+        if (found == by_name_.end())
+            by_name_[name] = index;
+        else
+            found->second = kAmbiguous;
+        by_lower_name_.insert(std::make_pair(toLower(name), index));
+        by_hash_.insert(std::make_pair(hashName(name.c_str()), index));
+    }
+
+    built_ = true;
+    stats_.rebuilds++;
+    return MS::kSuccess;
+}
+
+int JointIndex::lookupName(const std::string& name, bool& ambiguous) const
+{
+    ambiguous = false;
+    std::map<std::string, int>::const_iterator found = by_name_.find(name);
+    if (found != by_name_.end())
+    {
+        if (found->second != kAmbiguous)
+            return found->second;
+        ambiguous = true;
+        return -1;
+    }
+
+    found = by_lower_name_.find(toLower(name));
+    return found != by_lower_name_.end() ? found->second : -1;
+}
+
+int JointIndex::lookupHash(int name_hash) const
+{
+    std::map<int, int>::const_iterator found = by_hash_.find(name_hash);
+    return found != by_hash_.end() ? found->second : -1;
+}
+
+bool JointIndex::isCurrent(int index) const
+{
+    const MDagPath& path = paths_[index];
+    if (!path.isValid())
+        return false;
+    MFnDagNode fn_node(path);
+    return names_[index] == fn_node.name().asChar();
+}
+
+bool JointIndex::rebuild()
+{
+    if (built_ && rebuilt_)
+        return false;
+    rebuilt_ = true;
+    return build() == MS::kSuccess;
+}
+
+MStatus JointIndex::found(int index, MDagPath& path)
+{
+    if (index < 0 || !isCurrent(index))
+    {
+        stats_.misses++;
+        return MS::kNotFound;
+    }
+    path = paths_[index];
+    return MS::kSuccess;
+}
+
+MStatus JointIndex::findByName(const char* name, MDagPath& path)
+{
+    stats_.lookups++;
+    std::string key(name);
+    bool ambiguous = false;
+    int index = built_ ? lookupName(key, ambiguous) : -1;
+    if (!ambiguous && (index < 0 || !isCurrent(index)) && rebuild())
+        index = lookupName(key, ambiguous);
+
+    if (ambiguous)
+        return MS::kFailure;
+    return found(index, path);
+}
+
+MStatus JointIndex::findByHash(int name_hash, MDagPath& path)
+{
+    stats_.lookups++;
+    int index = built_ ? lookupHash(name_hash) : -1;
+    if ((index < 0 || !isCurrent(index)) && rebuild())
+        index = lookupHash(name_hash);
+
+    return found(index, path);
+}
+
+} // namespace riot
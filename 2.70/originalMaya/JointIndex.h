@@ -0,0 +1,95 @@
+/*
+    Copyright 2011 Even Entem (alias ThiSpawn).
+
+    This file is part of Riot File Translator Plug-in for AutoDesk Maya.
+
+    Autodesk Maya's lib is under :
+    Copyright 1995, 2006, 2008 Autodesk, Inc. All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful, 
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef RIOT__JOINTINDEX_H
+#define RIOT__JOINTINDEX_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <maya/MStatus.h>
+#include <maya/MDagPath.h>
+
+namespace riot {
+
+// the joints of the scene by name and by name hash (see hashName), built in
+// one pass over the dag and kept between the imports of a session.
+// a found path is checked against the scene, and the index is built again
+// (at most once per beginLookups) when it is stale or when a name is missing.
+// not thread safe, used by the importers on the main thread.
+class JointIndex
+{
+public:
+    struct Stats
+    {
+        Stats() : lookups(0), misses(0), rebuilds(0) {}
+
+        int lookups;
+        int misses; // names or hashes without a joint
+        int rebuilds;
+    };
+
+    // the one the importers share
+    static JointIndex& sessionIndex();
+
+    JointIndex();
+
+    MStatus build();
+
+    // before the lookups of an import, the scene may have changed since
+    void beginLookups() { rebuilt_ = false; }
+
+    // kSuccess, kNotFound, or kFailure when several joints have that exact name.
+    // the exact name is tried first, then without case.
+    MStatus findByName(const char* name, MDagPath& path);
+    // first joint in depth first order with that hash
+    MStatus findByHash(int name_hash, MDagPath& path);
+
+    int numJoints() const { return static_cast<int>(paths_.size()); }
+    const Stats& stats() const { return stats_; }
+
+private:
+    static const int kAmbiguous = -1;
+
+    // index of the joint or -1
+    int lookupName(const std::string& name, bool& ambiguous) const;
+    int lookupHash(int name_hash) const;
+    // the joint at index is still there and still has that name
+    bool isCurrent(int index) const;
+    // build() again unless it was already done since beginLookups()
+    bool rebuild();
+    // path of the joint at index if it is current, else counts a miss
+    MStatus found(int index, MDagPath& path);
+
+    std::vector<MDagPath> paths_;
+    std::vector<std::string> names_;
+    std::map<std::string, int> by_name_; // kAmbiguous for duplicates
+    std::map<std::string, int> by_lower_name_;
+    std::map<int, int> by_hash_;
+    bool built_;
+    bool rebuilt_;
+    Stats stats_;
+};
+
+} // namespace riot
+
+#endif
@@ -0,0 +1,224 @@
+/*
+    Copyright 2011 Even Entem (alias ThiSpawn).
+
+    This file is part of Riot File Translator Plug-in for AutoDesk Maya.
+
+    Autodesk Maya's lib is under :
+    Copyright 1995, 2006, 2008 Autodesk, Inc. All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful, 
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <LinearSkinning.h>
+
+#include <math.h>
+#include <string.h>
+
+#include <maya/MGlobal.h>
+
+#include <SknData.hpp>
+#include <SklData.hpp>
+#include <AnmData.hpp>
+#include <SklEvaluator.h>
+#include <BoneMatrices.h>
+#include <maya_misc.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RIOT_LINEAR_SKINNING_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace riot {
+
+LinearSkinning::LinearSkinning()
+    : num_vertices_(0), num_bones_(0)
+{
+}
+
+MStatus LinearSkinning::setMesh(const SknData& mesh, const SklData& skeleton)
+{
+    int num_vertices = mesh.vertices.size();
+    int num_bones = static_cast<int>(skeleton.bones.size());
+    int num_influences = skeleton.num_indices;
+    if (num_influences < 0 || num_influences > static_cast<int>(skeleton.skn_indices.length()))
+        FAILURE("LinearSkinning: the skeleton has no influence list");
+
+    bones_.resize(4 * num_vertices);
+    weights_.resize(4 * num_vertices);
+    for (int i = 0; i < num_vertices; i++)
+    {
+        float sum = 0.0f;
+        for (int j = 0; j < 4; j++)
+        {
+            float weight = mesh.vertices.weights[4 * i + j];
+            int n = mesh.vertices.skn_indices[4 * i + j];
+            int bone = 0;
+            if (weight != 0.0f)
+            {
+                if (n >= num_influences)
+                    FAILURE(MString("LinearSkinning: an influence is out of range for vtx[") + i + "]");
+                bone = skeleton.skn_indices[n];
+                if (bone < 0 || bone >= num_bones)
+                    FAILURE(MString("LinearSkinning: skn index ") + n + " is out of the skeleton");
+            }
+            bones_[4 * i + j] = bone;
+            weights_[4 * i + j] = weight;
+            sum += weight;
+        }
+        float scale = sum > 0.0f ? 1.0f / sum : 0.0f;
+        for (int j = 0; j < 4; j++)
+            weights_[4 * i + j] *= scale;
+    }
+
+    positions_ = mesh.vertices.positions;
+    normals_ = mesh.vertices.normals;
+    num_vertices_ = num_vertices;
+    num_bones_ = num_bones;
+    return MS::kSuccess;
+}
+
+void LinearSkinning::skinRange(const float* skinning_matrices, float* positions, float* normals,
+                               int begin, int end) const
+{
+    const float* in_positions = positions_.data();
+    const float* in_normals = normals_.data();
+    const float* weights = weights_.data();
+    const int* bones = bones_.empty() ? 0 : &bones_[0];
+
+    for (int i = begin; i < end; i++)
+    {
+        const float* w = weights + 4 * i;
+        const int* b = bones + 4 * i;
+        const float* p = in_positions + 4 * i;
+        const float* n = in_normals + 3 * i;
+
+#if defined(RIOT_LINEAR_SKINNING_SSE2)
+        // the rows of the blended matrix
+        __m128 rows[4];
+        for (int r = 0; r < 4; r++)
+            rows[r] = _mm_setzero_ps();
+        for (int j = 0; j < 4; j++)
+        {
+            if (w[j] == 0.0f)
+                continue;
+            const float* m = skinning_matrices + 16 * b[j];
+            __m128 weight = _mm_set1_ps(w[j]);
+            for (int r = 0; r < 4; r++)
+                rows[r] = _mm_add_ps(rows[r], _mm_mul_ps(weight, _mm_loadu_ps(m + 4 * r)));
+        }
+
+        __m128 position = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(p[0]), rows[0]),
+                                                _mm_mul_ps(_mm_set1_ps(p[1]), rows[1])),
+                                     _mm_add_ps(_mm_mul_ps(_mm_set1_ps(p[2]), rows[2]), rows[3]));
+        float out[4];
+        _mm_storeu_ps(out, position);
+        positions[4 * i] = out[0];
+        positions[4 * i + 1] = out[1];
+        positions[4 * i + 2] = out[2];
+        positions[4 * i + 3] = 1.0f;
+
+        if (normals)
+        {
+            __m128 normal = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(n[0]), rows[0]),
+                                                  _mm_mul_ps(_mm_set1_ps(n[1]), rows[1])),
+                                       _mm_mul_ps(_mm_set1_ps(n[2]), rows[2]));
+            _mm_storeu_ps(out, normal);
+            float length = sqrtf(out[0] * out[0] + out[1] * out[1] + out[2] * out[2]);
+            float scale = length > 0.0f ? 1.0f / length : 0.0f;
+            for (int c = 0; c < 3; c++)
+                normals[3 * i + c] = out[c] * scale;
+        }
+#else
+        float rows[16];
+        memset(rows, 0, sizeof(rows));
+        for (int j = 0; j < 4; j++)
+        {
+            if (w[j] == 0.0f)
+                continue;
+            const float* m = skinning_matrices + 16 * b[j];
+            for (int k = 0; k < 16; k++)
+                rows[k] += w[j] * m[k];
+        }
+
+        for (int c = 0; c < 3; c++)
+            positions[4 * i + c] = p[0] * rows[c] + p[1] * rows[4 + c] + p[2] * rows[8 + c] + rows[12 + c];
+        positions[4 * i + 3] = 1.0f;
+
+        if (normals)
+        {
+            float out[3];
+            for (int c = 0; c < 3; c++)
+                out[c] = n[0] * rows[c] + n[1] * rows[4 + c] + n[2] * rows[8 + c];
+            float length = sqrtf(out[0] * out[0] + out[1] * out[1] + out[2] * out[2]);
+            float scale = length > 0.0f ? 1.0f / length : 0.0f;
+            for (int c = 0; c < 3; c++)
+                normals[3 * i + c] = out[c] * scale;
+        }
+#endif
+    }
+}
+
+void LinearSkinning::skin(const float* skinning_matrices, float* positions, float* normals, bool parallel) const
+{
+    int num_chunks = (num_vertices_ + kChunkSize - 1) / kChunkSize;
+
+#pragma omp parallel for schedule(dynamic) if(parallel)
+    for (int c = 0; c < num_chunks; c++)
+    {
+        int begin = c * kChunkSize;
+        int end = begin + kChunkSize < num_vertices_ ? begin + kChunkSize : num_vertices_;
+        skinRange(skinning_matrices, positions, normals, begin, end);
+    }
+}
+
+MStatus LinearSkinning::skinFrames(const SklEvaluator& evaluator, const AnmData& animation, int first, int count,
+                                   float* positions, float* normals, bool parallel) const
+{
+    if (evaluator.numBones() != num_bones_)
+        FAILURE("LinearSkinning: the evaluator has another skeleton");
+
+    // world matrices of all the frames, then inverse bind * world in place
+    std::vector<float> matrices(static_cast<size_t>(count) * num_bones_ * 16 + 1);
+    if (evaluator.evaluateFrames(animation, first, count, &matrices[0], parallel) != MS::kSuccess)
+        return MS::kFailure;
+
+#pragma omp parallel for schedule(static) if(parallel)
+    for (int f = 0; f < count; f++)
+    {
+        for (int b = 0; b < num_bones_; b++)
+        {
+            float* world = &matrices[(static_cast<size_t>(f) * num_bones_ + b) * 16];
+            float skinning[16];
+            multiplyMatrices(evaluator.inverseBindMatrix(b), world, skinning);
+            memcpy(world, skinning, sizeof(skinning));
+        }
+    }
+
+    int num_chunks = (num_vertices_ + kChunkSize - 1) / kChunkSize;
+    int num_tasks = count * num_chunks;
+
+#pragma omp parallel for schedule(dynamic) if(parallel)
+    for (int t = 0; t < num_tasks; t++)
+    {
+        int f = t / num_chunks;
+        int begin = (t % num_chunks) * kChunkSize;
+        int end = begin + kChunkSize < num_vertices_ ? begin + kChunkSize : num_vertices_;
+        size_t frame = static_cast<size_t>(f) * num_vertices_;
+        skinRange(&matrices[static_cast<size_t>(f) * num_bones_ * 16], positions + 4 * frame,
+                  normals ? normals + 3 * frame : 0, begin, end);
+    }
+
+    return MS::kSuccess;
+}
+
+} // namespace riot
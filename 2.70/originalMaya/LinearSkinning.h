@@ -0,0 +1,82 @@
+/*
+    Copyright 2011 Even Entem (alias ThiSpawn).
+
+    This file is part of Riot File Translator Plug-in for AutoDesk Maya.
+
+    Autodesk Maya's lib is under :
+    Copyright 1995, 2006, 2008 Autodesk, Inc. All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful, 
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef RIOT__LINEARSKINNING_H
+#define RIOT__LINEARSKINNING_H
+
+#include <vector>
+
+#include <maya/MStatus.h>
+
+#include <AlignedArray.hpp>
+
+namespace riot {
+
+class SknData;
+struct SklData;
+struct AnmData;
+class SklEvaluator;
+
+// linear blend skinning of a skn on a skeleton, without maya, for
+// previews and checks of the exports.
+// each vertex is moved by the sum of the matrices of its 4 influences
+// times their weights, normalized to 1 as the importer does.
+class LinearSkinning
+{
+public:
+    static const int kChunkSize = 1024; // vertices per task
+
+    LinearSkinning();
+
+    // the influence n of a vertex is the bone skeleton.skn_indices[n],
+    // that's the bone n itself for skl version 1
+    MStatus setMesh(const SknData& mesh, const SklData& skeleton);
+
+    // skinning_matrices are inverse bind * world per bone of the skeleton
+    // (see SklEvaluator::skinningMatrices()). positions get x y z 1 and
+    // normals (if not null) x y z normalized per vertex.
+    // the vertices are split in chunks between threads when parallel.
+    void skin(const float* skinning_matrices, float* positions, float* normals, bool parallel = true) const;
+
+    // the frames [first, first + count) of animation, on the skeleton of
+    // evaluator (the same one as setMesh()), each frame after the other.
+    // the tasks are the chunks of every frame, split between threads.
+    MStatus skinFrames(const SklEvaluator& evaluator, const AnmData& animation, int first, int count,
+                       float* positions, float* normals, bool parallel = true) const;
+
+    int numVertices() const { return num_vertices_; }
+    int numBones() const { return num_bones_; }
+
+private:
+    // vertices [begin, end)
+    void skinRange(const float* skinning_matrices, float* positions, float* normals, int begin, int end) const;
+
+    int num_vertices_;
+    int num_bones_;
+    AlignedArray<float> positions_; // x y z 1
+    AlignedArray<float> normals_; // x y z
+    std::vector<int> bones_; // 4 per vertex, bones of the skeleton
+    AlignedArray<float> weights_; // 4 per vertex
+};
+
+} // namespace riot
+
+#endif
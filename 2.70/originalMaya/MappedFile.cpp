@@ -0,0 +1,148 @@
+/*
+    Copyright 2011 Even Entem (alias ThiSpawn).
+
+    This file is part of Riot File Translator Plug-in for AutoDesk Maya.
+
+    Autodesk Maya's lib is under :
+    Copyright 1995, 2006, 2008 Autodesk, Inc. All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful, 
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <MappedFile.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace riot {
+
+#if defined(_WIN32)
+
+MappedFile::MappedFile()
+    : data_(0), size_(0), file_handle_(INVALID_HANDLE_VALUE), mapping_handle_(0)
+{
+}
+
+bool MappedFile::open(const char* file_name)
+{
+    close();
+
+    file_handle_ = CreateFileA(file_name, GENERIC_READ, FILE_SHARE_READ, 0,
+                               OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, 0);
+    if (file_handle_ == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER length;
+    // empty files can't be mapped, and skins won't ever reach 2GB
+    if (!GetFileSizeEx(file_handle_, &length) || length.QuadPart == 0 || length.HighPart != 0)
+    {
+        close();
+        return false;
+    }
+
+    mapping_handle_ = CreateFileMappingA(file_handle_, 0, PAGE_READONLY, 0, 0, 0);
+    if (!mapping_handle_)
+    {
+        close();
+        return false;
+    }
+
+    data_ = reinterpret_cast<const char*>(MapViewOfFile(mapping_handle_, FILE_MAP_READ, 0, 0, 0));
+    if (!data_)
+    {
+        close();
+        return false;
+    }
+    size_ = static_cast<int>(length.LowPart);
+
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (data_)
+        UnmapViewOfFile(data_);
+    if (mapping_handle_)
+        CloseHandle(mapping_handle_);
+    if (file_handle_ != INVALID_HANDLE_VALUE)
+        CloseHandle(file_handle_);
+
+    data_ = 0;
+    size_ = 0;
+    mapping_handle_ = 0;
+    file_handle_ = INVALID_HANDLE_VALUE;
+}
+
+#else
+
+MappedFile::MappedFile()
+    : data_(0), size_(0), fd_(-1)
+{
+}
+
+bool MappedFile::open(const char* file_name)
+{
+    close();
+
+    fd_ = ::open(file_name, O_RDONLY);
+    if (fd_ == -1)
+        return false;
+
+    struct stat st;
+    // empty files can't be mapped, and skins won't ever reach 2GB
+    if (fstat(fd_, &st) != 0 || st.st_size == 0 || st.st_size > 0x7FFFFFFF)
+    {
+        close();
+        return false;
+    }
+
+    void* p = mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd_, 0);
+    if (p == MAP_FAILED)
+    {
+        close();
+        return false;
+    }
+    madvise(p, st.st_size, MADV_SEQUENTIAL);
+    data_ = reinterpret_cast<const char*>(p);
+    size_ = static_cast<int>(st.st_size);
+
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (data_)
+        munmap(const_cast<char*>(data_), size_);
+    if (fd_ != -1)
+        ::close(fd_);
+
+    data_ = 0;
+    size_ = 0;
+    fd_ = -1;
+}
+
+#endif
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+} // namespace riot
@@ -27,6 +27,8 @@
 #include <maya/MString.h>
 #include <maya/MColor.h>
 
+#include <Handedness.hpp>
+
 namespace riot {
 
 struct ScbMaterial
@@ -61,10 +63,13 @@ struct ScbData
     {
         int vertices_size = static_cast<int>(vertices.size());
         for (int i = 0; i < vertices_size; i++)
-            vertices.at(i).x = -vertices.at(i).x;
+        {
+            ScbVtx& vtx = vertices.at(i);
+            SwitchHand::position(vtx.x, vtx.y, vtx.z);
+        }
 
-        bbx = -bbx;
-        bbdx = -bbdx;
+        SwitchHand::position(bbx, bby, bbz);
+        SwitchHand::position(bbdx, bbdy, bbdz);
     }
 
     int version;
@@ -48,9 +48,11 @@
 #include <maya/MColorArray.h>
 
 #include <maya_misc.h>
+#include <TriangleFilter.h>
 
 namespace riot {
 
+template <class Hand>
 MStatus ScbReader::read(istream& file)
 {
     // get length
@@ -103,94 +105,101 @@ MStatus ScbReader::read(istream& file)
         file.read(reinterpret_cast<char*>(&data_.bbdx), 4);
         file.read(reinterpret_cast<char*>(&data_.bbdy), 4);
         file.read(reinterpret_cast<char*>(&data_.bbdz), 4);
+        Hand::position(data_.bbx, data_.bby, data_.bbz);
+        Hand::position(data_.bbdx, data_.bbdy, data_.bbdz);
     }
 
+    // the counts come from the header, they must fit in what is left of
+    // the file before anything is sized from them
+    // a face is 3 indices, a material name, 3 U and 3 V
+    const int face_size = 12 + ScbMaterial::kNameLen + 24;
+    long long left = static_cast<long long>(length) - static_cast<long long>(file.tellg());
+    if (num_vtx < 0 || num_faces < 0 ||
+        static_cast<long long>(num_vtx) * ScbVtx::kSizeInFile > left ||
+        static_cast<long long>(num_faces) * face_size > left - static_cast<long long>(num_vtx) * ScbVtx::kSizeInFile)
+        FAILURE("ScbReader: the vertex or face count doesn't fit in the file");
+
     // get vertices
     for (int i = 0; i < num_vtx; i++)
     {
         ScbVtx vtx;
         file.read(reinterpret_cast<char*>(&vtx), ScbVtx::kSizeInFile);
+        Hand::position(vtx.x, vtx.y, vtx.z);
         data_.vertices.push_back(vtx);
     }
     
     // get faces
+    std::vector<char> faces(static_cast<size_t>(num_faces) * face_size);
+    if (num_faces)
+    {
+        file.read(&faces[0], static_cast<std::streamsize>(faces.size()));
+        if (file.gcount() != static_cast<std::streamsize>(faces.size()))
+            FAILURE("ScbReader: unexpected end of file in the faces");
+    }
+
+    std::vector<int> indices(num_faces * 3);
+    for (int i = 0; i < num_faces; i++)
+        memcpy(&indices[i * 3], &faces[i * face_size], 12);
+
+    // check which faces can build a triangle
+    std::vector<unsigned char> kept(num_faces);
+    data_.indices.resize(num_faces * 3);
+    int num_bad_faces = 0;
+    if (num_faces)
+        num_bad_faces = filterTriangles(&indices[0], num_faces, data_.num_vtxs, &data_.indices[0], &kept[0]);
+    if (num_bad_faces)
+    {
+        MGlobal::displayWarning(MString("ScbReader: input mesh has ") + num_bad_faces
+                                + " badly built triangle(s), removing them...");
+        data_.num_indices -= 3 * num_bad_faces;
+        data_.indices.resize(data_.num_indices);
+    }
+
     char mat_name[ScbMaterial::kNameLen];
-    bool did_face_fail;
     for (int i = 0; i < num_faces; i++)
     {
-        did_face_fail = false;
-        // get indices
-        int indices[3];
-        file.read(reinterpret_cast<char*>(&indices), 12);
-        // check if that can build a triangle
-        if (indices[0] == indices[1] ||
-            indices[0] == indices[2] ||
-            indices[1] == indices[2] ||
-            indices[0] < 0 ||
-            indices[0] >= data_.num_vtxs ||
-            indices[1] < 0 ||
-            indices[1] >= data_.num_vtxs ||
-            indices[2] < 0 ||
-            indices[2] >= data_.num_vtxs)
+        if (!kept[i])
+            continue;
+
+        const char* face = &faces[i * face_size];
+
+        // get mat_name[64];
+        memcpy(mat_name, face + 12, ScbMaterial::kNameLen);
+        int c = 0;
+        for (; c < ScbMaterial::kNameLen; c++)
         {
-            MGlobal::displayWarning("ScbReader: input mesh has a badly built triangle, removing it...");
-            data_.num_indices -= 3;
-            did_face_fail = true;
+            if (mat_name[c] == '\0')
+                break;
         }
-        else
+        if (c == ScbMaterial::kNameLen)
         {
-            data_.indices.push_back(indices[0]);
-            data_.indices.push_back(indices[1]);
-            data_.indices.push_back(indices[2]);
+            MGlobal::displayWarning("ScbReader: material name too long\nreport this error to ThiSpawn");
+            mat_name[ScbMaterial::kNameLen - 1] = '\0';
         }
 
-        // get mat_name[64];
-        file.read(mat_name, ScbMaterial::kNameLen);
-        if (!did_face_fail)
+        int j = 0;
+        int data_materials_size = static_cast<int>(data_.materials.size());
+        for (; j < data_materials_size; j++)
         {
-            int c = 0;
-            for (; c < ScbMaterial::kNameLen; c++)
-            {
-                if (mat_name[c] == '\0')
-                    break;
-            }
-            if (c == ScbMaterial::kNameLen)
-                MGlobal::displayWarning("ScbReader: material name too long\nreport this error to ThiSpawn");
-
-            int j = 0;
-            int data_materials_size = static_cast<int>(data_.materials.size());
-            for (; j < data_materials_size; j++)
-            {
-                if (!strcmp(data_.materials.at(j).name, mat_name))
-                    break;
-            }
-            if (j == data_materials_size)
-            {
-                MGlobal::displayInfo(MString("found new material : ") + mat_name);
-                ScbMaterial new_mat;
-                strcpy_s(new_mat.name, ScbMaterial::kNameLen, mat_name);
-                data_.materials.push_back(new_mat);
-            }
-            data_.shader_per_triangle.push_back(j);
+            if (!strcmp(data_.materials.at(j).name, mat_name))
+                break;
         }
-
-        // get u_vec
-        for (int k = 0; k < 3; k++)
+        if (j == data_materials_size)
         {
-            float u;
-            file.read(reinterpret_cast<char*>(&u), 4);
-            if (!did_face_fail)
-                data_.u_vec.push_back(u);
+            MGlobal::displayInfo(MString("found new material : ") + mat_name);
+            ScbMaterial new_mat;
+            strcpy_s(new_mat.name, ScbMaterial::kNameLen, mat_name);
+            data_.materials.push_back(new_mat);
         }
+        data_.shader_per_triangle.push_back(j);
 
-        // get v_vec
+        // get u_vec and v_vec
+        float uvs[6];
+        memcpy(uvs, face + 12 + ScbMaterial::kNameLen, 24);
         for (int k = 0; k < 3; k++)
-        {
-            float v;
-            file.read(reinterpret_cast<char*>(&v), 4);
-            if (!did_face_fail)
-                data_.v_vec.push_back(v);
-        }
+            data_.u_vec.push_back(uvs[k]);
+        for (int k = 0; k < 3; k++)
+            data_.v_vec.push_back(uvs[3 + k]);
     }
 
     if (is_colored)
@@ -205,11 +214,14 @@ MStatus ScbReader::read(istream& file)
         }
     }
 
-    data_.switchHand();
-
     return MS::kSuccess;
 }
 
+template MStatus ScbReader::read<SwitchHand>(istream& file);
+template MStatus ScbReader::read<KeepHand>(istream& file);
+
+#ifndef RIOT_HEADLESS
+
 MStatus ScbReader::loadData()
 {
     MFnSkinCluster fn_skin_cluster;
@@ -407,5 +419,7 @@ MStatus ScbReader::loadData()
     return MS::kSuccess;
 }
 
+#endif // RIOT_HEADLESS
+
 } // namespace riot
 
@@ -28,13 +28,16 @@
 #include <maya/MIOStream.h>
 
 #include <ScbData.hpp>
+#include <Handedness.hpp>
 
 namespace riot {
 
 class ScbReader
 {
 public:
-    MStatus read(istream& file);
+    // Hand is SwitchHand or KeepHand, see Handedness.hpp
+    template <class Hand> MStatus read(istream& file);
+    MStatus read(istream& file) { return read<SwitchHand>(file); }
     MStatus loadData();
 
     ScbData data_;
@@ -45,10 +45,9 @@
 
 namespace riot {
 
+template <class Hand>
 MStatus ScbWriter::write(ostream& file)
 {
-    data_.switchHand();
-
     // magic
     char magic[9] = "r3d2Mesh";
     file.write(magic, 8);
@@ -72,17 +71,16 @@ MStatus ScbWriter::write(ostream& file)
     file.write(reinterpret_cast<char*>(&colored), 4);
 
     // set transform
-    file.write(reinterpret_cast<char*>(&data_.bbx), 4);
-    file.write(reinterpret_cast<char*>(&data_.bby), 4);
-    file.write(reinterpret_cast<char*>(&data_.bbz), 4);
-    file.write(reinterpret_cast<char*>(&data_.bbdx), 4);
-    file.write(reinterpret_cast<char*>(&data_.bbdy), 4);
-    file.write(reinterpret_cast<char*>(&data_.bbdz), 4);
+    float bb[6] = {data_.bbx, data_.bby, data_.bbz, data_.bbdx, data_.bbdy, data_.bbdz};
+    Hand::position(bb[0], bb[1], bb[2]);
+    Hand::position(bb[3], bb[4], bb[5]);
+    file.write(reinterpret_cast<char*>(bb), 24);
 
     // set vertices
     for (int i = 0; i < num_vtx; i++)
     {
         ScbVtx vtx = data_.vertices[i];
+        Hand::position(vtx.x, vtx.y, vtx.z);
         file.write(reinterpret_cast<char*>(&vtx), ScbVtx::kSizeInFile);
     }
     
@@ -133,6 +131,11 @@ MStatus ScbWriter::write(ostream& file)
     return MS::kSuccess;
 }
 
+template MStatus ScbWriter::write<SwitchHand>(ostream& file);
+template MStatus ScbWriter::write<KeepHand>(ostream& file);
+
+#ifndef RIOT_HEADLESS
+
 MStatus ScbWriter::dumpData()
 {
     MStatus status;
@@ -285,5 +288,7 @@ MStatus ScbWriter::dumpData()
     return MS::kSuccess;
 }
 
+#endif // RIOT_HEADLESS
+
 } // namespace riot
 
@@ -26,6 +26,8 @@
 
 #include <maya/MString.h>
 
+#include <Handedness.hpp>
+
 namespace riot {
 
 const int kMaxBufLen = 0x100;
@@ -53,10 +55,13 @@ struct ScoData
     {
         int vertices_size = static_cast<int>(vertices.size());
         for (int i = 0; i < vertices_size; i++)
-            vertices.at(i).x = -vertices.at(i).x;
+        {
+            ScoVtx& vtx = vertices.at(i);
+            SwitchHand::position(vtx.x, vtx.y, vtx.z);
+        }
         
-        tx = -tx;
-        px = -px;
+        SwitchHand::position(tx, ty, tz);
+        SwitchHand::position(px, py, pz);
     }
 
     MString name;
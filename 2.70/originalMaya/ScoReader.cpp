@@ -47,9 +47,11 @@
 #include <maya/MFnIkJoint.h>
 
 #include <maya_misc.h>
+#include <TriangleFilter.h>
 
 namespace riot {
 
+template <class Hand>
 MStatus ScoReader::read(istream& file)
 {
     char buffer[kMaxBufLen];
@@ -72,6 +74,7 @@ MStatus ScoReader::read(istream& file)
     // get central point
     file.getline(buffer, kMaxBufLen);
     sscanf_s(buffer, "%s %f %f %f", attr_name, kMaxBufLen, &data_.tx, &data_.ty, &data_.tz);
+    Hand::position(data_.tx, data_.ty, data_.tz);
 
     //MGlobal::displayInfo(MString("CentralPoint= ") + data_.tx + " " + data_.ty + " " + data_.tz);
 
@@ -81,6 +84,7 @@ MStatus ScoReader::read(istream& file)
     if (!strncmp(attr_name, "PivotPoint=", 11))
     {
         sscanf_s(buffer, "%s %f %f %f", attr_name, kMaxBufLen, &data_.px, &data_.py, &data_.pz);
+        Hand::position(data_.px, data_.py, data_.pz);
         data_.use_pivot = true;
         file.getline(buffer, kMaxBufLen);
     }
@@ -94,83 +98,109 @@ MStatus ScoReader::read(istream& file)
         ScoVtx vtx;
         file.getline(buffer, kMaxBufLen);
         sscanf_s(buffer, "%f %f %f", &vtx.x, &vtx.y, &vtx.z);
+        Hand::position(vtx.x, vtx.y, vtx.z);
         data_.vertices.push_back(vtx);
     }
 
     // get faces
-    int num_faces; // but red as int
+    int num_faces = 0; // but red as int
     file.getline(buffer, kMaxBufLen);
     sscanf_s(buffer, "%s %d", attr_name, kMaxBufLen, &num_faces);
+
+    // a face line has 11 fields, each at least a character and a separator.
+    // the count must fit in the rest of the file before the arrays are sized
+    long long position = static_cast<long long>(file.tellg());
+    file.seekg(0, ios::end);
+    long long left = static_cast<long long>(file.tellg()) - position;
+    file.seekg(position, ios::beg);
+    const int kMinFaceLine = 2 * 11;
+    if (num_faces < 0 || position < 0 || static_cast<long long>(num_faces) * kMinFaceLine > left)
+        FAILURE("ScoReader: the face count doesn't fit in the file");
+
     data_.num_indices = num_faces * 3;
+    std::vector<int> indices(num_faces * 3);
+    std::vector<MString> mat_names(num_faces);
+    std::vector<double> uvs(num_faces * 6);
     for (int i = 0; i < num_faces; i++)
     {
         char *pch;
         char *next_token;
-        MString mat_name;
-        int indices[3];
         file.getline(buffer, kMaxBufLen);
         pch = strtok_s(buffer, " \t", &next_token);
         int vertexCount = atoi(pch);
         if (vertexCount != 3)
             FAILURE("ScoReader: vertexCount for a face is != 3");
         pch = strtok_s(0, " \t", &next_token);
-        indices[0] = atoi(pch);
+        indices[i * 3] = atoi(pch);
         pch = strtok_s(0, " \t", &next_token);
-        indices[1] = atoi(pch);
+        indices[i * 3 + 1] = atoi(pch);
         pch = strtok_s(0, " \t", &next_token);
-        indices[2] = atoi(pch);
+        indices[i * 3 + 2] = atoi(pch);
         pch = strtok_s(0, " \t", &next_token);
-        mat_name = pch;
-        pch += mat_name.length() + 1;
-
-        if (indices[0] == indices[1] ||
-            indices[0] == indices[2] ||
-            indices[1] == indices[2] ||
-            indices[0] < 0 ||
-            indices[0] >= data_.num_vtxs ||
-            indices[1] < 0 ||
-            indices[1] >= data_.num_vtxs ||
-            indices[2] < 0 ||
-            indices[2] >= data_.num_vtxs)
+        mat_names[i] = pch;
+        pch += mat_names[i].length() + 1;
+
+        for (int k = 0; k < 3; k++)
         {
-            MGlobal::displayWarning("ScoReader: input mesh has a badly built triangle, removing it...");
-            data_.num_indices -= 3;
+            uvs[i * 6 + k * 2] = strtod(pch, &pch);
+            uvs[i * 6 + k * 2 + 1] = strtod(pch, &pch);
         }
-        else
+    }
+
+    // check which faces can build a triangle
+    std::vector<unsigned char> kept(num_faces);
+    data_.indices.resize(num_faces * 3);
+    int num_bad_faces = 0;
+    if (num_faces)
+        num_bad_faces = filterTriangles(&indices[0], num_faces, data_.num_vtxs, &data_.indices[0], &kept[0]);
+    if (num_bad_faces)
+    {
+        MGlobal::displayWarning(MString("ScoReader: input mesh has ") + num_bad_faces
+                                + " badly built triangle(s), removing them...");
+        data_.num_indices -= 3 * num_bad_faces;
+        data_.indices.resize(data_.num_indices);
+    }
+
+    for (int i = 0; i < num_faces; i++)
+    {
+        if (!kept[i])
+            continue;
+
+        const MString& mat_name = mat_names[i];
+        int j = 0;
+        int data_materials_size = static_cast<int>(data_.materials.size());
+        for (; j < data_materials_size; j++)
         {
-            int j = 0;
-            int data_materials_size = static_cast<int>(data_.materials.size());
-            for (; j < data_materials_size; j++)
-            {
-                if (data_.materials.at(j).name == mat_name)
-                    break;
-            }
-            if (j == data_materials_size)
-            {
-                MGlobal::displayInfo("found new material : " + mat_name);
-                ScoMaterial new_mat;
-                new_mat.name = mat_name;
-                if (mat_name.length() > ScoMaterial::kMaxNameLen)
-                    MGlobal::displayWarning("ScoReader: material name too long\nreport this error to ThiSpawn");
-                data_.materials.push_back(new_mat);
-            }
-            
-            data_.shader_per_triangle.push_back(j);
-
-            for (int k = 0; k < 3; k++)
-            {
-                data_.indices.push_back(indices[k]);
-                data_.u_vec.push_back(strtod(pch, &pch));
-                data_.v_vec.push_back(strtod(pch, &pch));
-            }
+            if (data_.materials.at(j).name == mat_name)
+                break;
         }
-    }
+        if (j == data_materials_size)
+        {
+            MGlobal::displayInfo("found new material : " + mat_name);
+            ScoMaterial new_mat;
+            new_mat.name = mat_name;
+            if (mat_name.length() > ScoMaterial::kMaxNameLen)
+                MGlobal::displayWarning("ScoReader: material name too long\nreport this error to ThiSpawn");
+            data_.materials.push_back(new_mat);
+        }
+        
+        data_.shader_per_triangle.push_back(j);
 
-    data_.switchHand();
+        for (int k = 0; k < 3; k++)
+        {
+            data_.u_vec.push_back(uvs[i * 6 + k * 2]);
+            data_.v_vec.push_back(uvs[i * 6 + k * 2 + 1]);
+        }
+    }
 
     return MS::kSuccess;
 }
 
+template MStatus ScoReader::read<SwitchHand>(istream& file);
+template MStatus ScoReader::read<KeepHand>(istream& file);
+
+#ifndef RIOT_HEADLESS
+
 MStatus ScoReader::loadData()
 {
     MFnSkinCluster fn_skin_cluster;
@@ -355,5 +385,7 @@ MStatus ScoReader::loadData()
     return MS::kSuccess;
 }
 
+#endif // RIOT_HEADLESS
+
 } // namespace riot
 
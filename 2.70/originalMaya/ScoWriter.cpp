@@ -47,26 +47,32 @@
 
 namespace riot {
 
+template <class Hand>
 MStatus ScoWriter::write(ostream& file)
 {
-    data_.switchHand();
-
     // set magic
     file << "[ObjectBegin]" << std::endl;
 
     // set name
-    if (data_.name.length() > ScoData::kMaxNameLen)
-        data_.name = data_.name.substring(0, ScoData::kMaxNameLen - 1);
-    file << "Name= " << data_.name << std::endl;
+    MString name = data_.name;
+    if (name.length() > ScoData::kMaxNameLen)
+        name = name.substring(0, ScoData::kMaxNameLen - 1);
+    file << "Name= " << name << std::endl;
 
     file << std::fixed;
     file << std::setprecision(4);
     // set central point
-    file << "CentralPoint= " << data_.tx << " " << data_.ty << " " << data_.tz << std::endl;
+    float tx = data_.tx, ty = data_.ty, tz = data_.tz;
+    Hand::position(tx, ty, tz);
+    file << "CentralPoint= " << tx << " " << ty << " " << tz << std::endl;
 
     // set pivot point
     if (data_.use_pivot)
-        file << "PivotPoint= " << data_.px << " " << data_.py << " " << data_.pz << std::endl;
+    {
+        float px = data_.px, py = data_.py, pz = data_.pz;
+        Hand::position(px, py, pz);
+        file << "PivotPoint= " << px << " " << py << " " << pz << std::endl;
+    }
     
     // set vertices
     int num_vtx = data_.num_vtxs;
@@ -74,6 +80,7 @@ MStatus ScoWriter::write(ostream& file)
     for (int i = 0; i < num_vtx; i++)
     {
         ScoVtx vtx = data_.vertices.at(i);
+        Hand::position(vtx.x, vtx.y, vtx.z);
         file << vtx.x << " " << vtx.y << " " << vtx.z << std::endl;
     }
 
@@ -108,6 +115,11 @@ MStatus ScoWriter::write(ostream& file)
     return MS::kSuccess;
 }
 
+template MStatus ScoWriter::write<SwitchHand>(ostream& file);
+template MStatus ScoWriter::write<KeepHand>(ostream& file);
+
+#ifndef RIOT_HEADLESS
+
 MStatus ScoWriter::dumpData()
 {
     MStatus status;
@@ -263,5 +275,7 @@ MStatus ScoWriter::dumpData()
     return MS::kSuccess;
 }
 
+#endif // RIOT_HEADLESS
+
 } // namespace riot
 
@@ -28,13 +28,17 @@
 #include <maya/MIOStream.h>
 
 #include <ScoData.hpp>
+#include <Handedness.hpp>
 
 namespace riot {
 
 class ScoWriter
 {
 public:
-    MStatus write(ostream& file);
+    // Hand is SwitchHand or KeepHand, see Handedness.hpp
+    // data_ is left untouched, so it can be written more than once
+    template <class Hand> MStatus write(ostream& file);
+    MStatus write(ostream& file) { return write<SwitchHand>(file); }
     MStatus dumpData();
 
     ScoData data_;
@@ -28,6 +28,7 @@
 
 #include <maya/MStatus.h>
 #include <maya/MString.h>
+#include <maya/MStringArray.h>
 #include <maya/MGlobal.h>
 #include <maya/MIOStream.h>
 #include <maya/MFStream.h>
@@ -45,7 +46,7 @@ void* SkExporter::creator()
 }
 
 MStatus SkExporter::writer(const MFileObject& file, 
-    const MString& /*options*/, 
+    const MString& options, 
     MPxFileTranslator::FileAccessMode mode) 
 {
     if (MPxFileTranslator::kExportActiveAccessMode != mode)
@@ -65,6 +66,28 @@ MStatus SkExporter::writer(const MFileObject& file,
         const MString skn_file_name = file.fullName();
     #endif
 
+    MStringArray option_list;
+    MStringArray the_option;
+    options.split(';', option_list);
+
+    bool optimize_vertex_cache = false;
+
+    int num_options = static_cast<int>(option_list.length());
+    for (int i = 0; i < num_options; i++)
+    {
+        the_option.clear();
+        option_list[i].split('=', the_option);
+        if (the_option.length() < 1)
+        {
+            continue;
+        }
+
+        if (the_option[0] == "vertexCache" && the_option.length() > 1)
+        {
+            optimize_vertex_cache = (the_option[1].asUnsigned() != 0);
+        }
+    }
+
     MString file_base_name = file.name();
     int rindex = file_base_name.rindexW('.');
     if (rindex != -1)
@@ -104,6 +127,13 @@ MStatus SkExporter::writer(const MFileObject& file,
         FAILURE("sk::Exporter: skn_writer->dumpData(); failed");
     }
 
+    if (optimize_vertex_cache && MStatus::kFailure == skn_writer->optimizeVertexCache())
+    {
+        delete skn_writer;
+        delete skl_writer;
+        FAILURE("sk::Exporter: skn_writer->optimizeVertexCache(); failed");
+    }
+
     // it's time to write the stuff;
     if (MStatus::kFailure == skn_writer->write(fout_skn))
     {
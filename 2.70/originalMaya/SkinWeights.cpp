@@ -0,0 +1,223 @@
+/*
+    Copyright 2011 Even Entem (alias ThiSpawn).
+
+    This file is part of Riot File Translator Plug-in for AutoDesk Maya.
+
+    Autodesk Maya's lib is under :
+    Copyright 1995, 2006, 2008 Autodesk, Inc. All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful, 
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <SkinWeights.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RIOT_SKIN_WEIGHTS_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace riot {
+
+namespace {
+
+// the biggest weights of a row, sorted from the biggest.
+// a weight goes in only if it is strictly bigger, so 0 never does and
+// the first influence keeps its place on a tie.
+struct TopInfluences
+{
+#if defined(RIOT_SKIN_WEIGHTS_SSE2)
+    TopInfluences()
+        : weights_(_mm_setzero_ps()), influences_(_mm_set1_epi32(-1))
+    {
+    }
+
+    void insert(float weight, int influence)
+    {
+        __m128 w = _mm_set1_ps(weight);
+        __m128 bigger = _mm_cmpgt_ps(w, weights_);
+        if (!_mm_movemask_ps(bigger))
+            return;
+
+        // bigger is set from the slot the weight goes in to the end,
+        // the slots after that one get their left neighbour.
+        __m128i bigger_i = _mm_castps_si128(bigger);
+        __m128i shift = _mm_slli_si128(bigger_i, 4);
+        __m128i insert_at = _mm_andnot_si128(shift, bigger_i);
+
+        __m128i old_weights = _mm_castps_si128(weights_);
+        __m128i new_weights = _mm_or_si128(
+            _mm_andnot_si128(bigger_i, old_weights),
+            _mm_or_si128(_mm_and_si128(shift, _mm_slli_si128(old_weights, 4)),
+                         _mm_and_si128(insert_at, _mm_castps_si128(w))));
+        weights_ = _mm_castsi128_ps(new_weights);
+
+        influences_ = _mm_or_si128(
+            _mm_andnot_si128(bigger_i, influences_),
+            _mm_or_si128(_mm_and_si128(shift, _mm_slli_si128(influences_, 4)),
+                         _mm_and_si128(insert_at, _mm_set1_epi32(influence))));
+    }
+
+    void get(float* weights, int* influences) const
+    {
+        _mm_storeu_ps(weights, weights_);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(influences), influences_);
+    }
+
+private:
+    __m128 weights_;
+    __m128i influences_;
+#else
+    TopInfluences()
+    {
+        for (int i = 0; i < kMaxVertexInfluences; i++)
+        {
+            weights_[i] = 0;
+            influences_[i] = -1;
+        }
+    }
+
+    void insert(float weight, int influence)
+    {
+        if (!(weight > weights_[kMaxVertexInfluences - 1]))
+            return;
+
+        int i = kMaxVertexInfluences - 1;
+        for (; i > 0 && weight > weights_[i - 1]; i--)
+        {
+            weights_[i] = weights_[i - 1];
+            influences_[i] = influences_[i - 1];
+        }
+        weights_[i] = weight;
+        influences_[i] = influence;
+    }
+
+    void get(float* weights, int* influences) const
+    {
+        for (int i = 0; i < kMaxVertexInfluences; i++)
+        {
+            weights[i] = weights_[i];
+            influences[i] = influences_[i];
+        }
+    }
+
+private:
+    float weights_[kMaxVertexInfluences];
+    int influences_[kMaxVertexInfluences];
+#endif
+};
+
+void selectRange(const double* weights, int begin, int end, int num_influences,
+                 int* influences, float* out_weights, InfluenceReport& report)
+{
+    for (int i = begin; i < end; i++)
+    {
+        const double* row = weights + static_cast<long long>(i) * num_influences;
+        TopInfluences top;
+        int num_weights = 0;
+        double sum = 0;
+        for (int j = 0; j < num_influences; j++)
+        {
+            double weight = row[j];
+            if (weight > 0)
+            {
+                num_weights++;
+                sum += weight;
+                top.insert(static_cast<float>(weight), j);
+            }
+        }
+
+        float kept_weights[kMaxVertexInfluences];
+        int kept_influences[kMaxVertexInfluences];
+        top.get(kept_weights, kept_influences);
+
+        // back in influence order, the unused slots (-1) last
+        for (int j = 1; j < kMaxVertexInfluences; j++)
+        {
+            for (int k = j; k > 0 && kept_influences[k] >= 0 &&
+                            (kept_influences[k - 1] < 0 || kept_influences[k] < kept_influences[k - 1]); k--)
+            {
+                float w = kept_weights[k];
+                kept_weights[k] = kept_weights[k - 1];
+                kept_weights[k - 1] = w;
+                int inf = kept_influences[k];
+                kept_influences[k] = kept_influences[k - 1];
+                kept_influences[k - 1] = inf;
+            }
+        }
+
+        double kept_sum = 0;
+        for (int j = 0; j < kMaxVertexInfluences; j++)
+            kept_sum += kept_weights[j];
+
+        float scale = kept_sum > 0 ? static_cast<float>(1.0 / kept_sum) : 0.0f;
+        int* vertex_influences = influences + kMaxVertexInfluences * i;
+        float* vertex_weights = out_weights + kMaxVertexInfluences * i;
+        for (int j = 0; j < kMaxVertexInfluences; j++)
+        {
+            vertex_influences[j] = kept_influences[j];
+            vertex_weights[j] = kept_weights[j] * scale;
+        }
+
+        if (num_weights > report.max_influences)
+            report.max_influences = num_weights;
+        if (!num_weights)
+            report.num_unweighted++;
+        if (num_weights > kMaxVertexInfluences)
+        {
+            report.num_pruned++;
+            double pruned = (sum - kept_sum) / sum;
+            if (pruned > report.max_pruned_weight)
+                report.max_pruned_weight = pruned;
+        }
+    }
+}
+
+} // namespace
+
+void selectInfluences(const double* weights, int num_vertices, int num_influences,
+                      int* influences, float* out_weights, InfluenceReport& report)
+{
+    report = InfluenceReport();
+    if (num_vertices <= 0)
+        return;
+
+    // rows of a few thousands vertices, each thread sums its own report
+    const int kRowsPerBlock = 4096;
+    int num_blocks = (num_vertices + kRowsPerBlock - 1) / kRowsPerBlock;
+
+#pragma omp parallel
+    {
+        InfluenceReport local;
+
+#pragma omp for schedule(dynamic)
+        for (int block = 0; block < num_blocks; block++)
+        {
+            int begin = block * kRowsPerBlock;
+            int end = begin + kRowsPerBlock < num_vertices ? begin + kRowsPerBlock : num_vertices;
+            selectRange(weights, begin, end, num_influences, influences, out_weights, local);
+        }
+
+#pragma omp critical
+        {
+            report.num_pruned += local.num_pruned;
+            report.num_unweighted += local.num_unweighted;
+            if (local.max_influences > report.max_influences)
+                report.max_influences = local.max_influences;
+            if (local.max_pruned_weight > report.max_pruned_weight)
+                report.max_pruned_weight = local.max_pruned_weight;
+        }
+    }
+}
+
+} // namespace riot
+
@@ -0,0 +1,54 @@
+/*
+    Copyright 2011 Even Entem (alias ThiSpawn).
+
+    This file is part of Riot File Translator Plug-in for AutoDesk Maya.
+
+    Autodesk Maya's lib is under :
+    Copyright 1995, 2006, 2008 Autodesk, Inc. All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful, 
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef RIOT__SKINWEIGHTS_H
+#define RIOT__SKINWEIGHTS_H
+
+namespace riot {
+
+// a skn vertex has 4 influences at most
+const int kMaxVertexInfluences = 4;
+
+struct InfluenceReport
+{
+    InfluenceReport()
+        : num_pruned(0), num_unweighted(0), max_influences(0), max_pruned_weight(0)
+    {
+    }
+
+    int num_pruned; // vertices which had more than kMaxVertexInfluences influences
+    int num_unweighted; // vertices with no weight at all
+    int max_influences; // most influences found on a vertex
+    double max_pruned_weight; // biggest share of a vertex weight that was pruned
+};
+
+// weights : num_vertices rows of num_influences, as MFnSkinCluster::getWeights()
+// gives them. the kMaxVertexInfluences biggest weights of each vertex are kept
+// (the lower influence wins a tie) and renormalized to sum to 1.
+// influences / out_weights get kMaxVertexInfluences entries per vertex, in
+// influence order, the unused ones are -1 / 0.
+// the vertices are split between threads when openmp is there.
+void selectInfluences(const double* weights, int num_vertices, int num_influences,
+                      int* influences, float* out_weights, InfluenceReport& report);
+
+} // namespace riot
+
+#endif
@@ -26,10 +26,9 @@
 
 #include <maya/MDagPathArray.h>
 #include <maya/MIntArray.h>
-#include <maya/MMatrix.h>
-#include <maya/MTransformationMatrix.h>
-#include <maya/MQuaternion.h>
-#include <maya/MVector.h>
+
+#include <Handedness.hpp>
+#include <BoneMatrices.h>
 
 namespace riot {
 
@@ -59,28 +58,8 @@ struct SklData
 
     void switchHand()
     {
-        int bones_size = static_cast<int>(bones.size());
-        for (int i = 0; i < bones_size; i++)
-        {
-            SklBone& bone = bones.at(i);
-            MMatrix mat(bone.transform);
-            MTransformationMatrix transMat(mat);
-            MQuaternion rot = transMat.rotation();
-            transMat.setRotationQuaternion(rot.x, -rot.y, -rot.z, rot.w);
-            mat = transMat.asMatrix();
-            /*
-            in maya : 
-            T  =    |  1    0    0    0 |
-                    |  0    1    0    0 |
-                    |  0    0    1    0 |
-                    |  tx   ty   tz   1 |
-            http://download.autodesk.com/us/maya/2011help/API/class_m_transformation_matrix.html
-            */
-            mat[3][0] = -mat[3][0];
-            for (int j = 0; j < 4; j++)
-                for (int k = 0; k < 4; k++)
-                    bone.transform[j][k] = static_cast<float>(mat[j][k]);
-        }
+        if (!bones.empty())
+            switchHandMatrices(&bones[0].transform[0][0], static_cast<int>(bones.size()), sizeof(SklBone));
     }
     
     int version;
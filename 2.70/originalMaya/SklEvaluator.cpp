@@ -0,0 +1,355 @@
+/*
+    Copyright 2011 Even Entem (alias ThiSpawn).
+
+    This file is part of Riot File Translator Plug-in for AutoDesk Maya.
+
+    Autodesk Maya's lib is under :
+    Copyright 1995, 2006, 2008 Autodesk, Inc. All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful, 
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <SklEvaluator.h>
+
+#include <map>
+#include <string>
+
+#include <math.h>
+#include <string.h>
+
+#include <maya/MGlobal.h>
+
+#include <SklData.hpp>
+#include <AnmData.hpp>
+#include <BoneMatrices.h>
+#include <maya_misc.h>
+
+namespace riot {
+
+namespace {
+
+// rotation x y z w then translation
+const int kPoseSize = 7;
+
+// of an affine matrix : the 3x3 inverted, the translation moved back
+void invert(const float* m, float* out)
+{
+    double a = m[0], b = m[1], c = m[2];
+    double d = m[4], e = m[5], f = m[6];
+    double g = m[8], h = m[9], k = m[10];
+    double c0 = e * k - f * h;
+    double c1 = f * g - d * k;
+    double c2 = d * h - e * g;
+    double det = a * c0 + b * c1 + c * c2;
+    double inv = det != 0.0 ? 1.0 / det : 0.0;
+
+    double r[9] = {
+        c0 * inv, (c * h - b * k) * inv, (b * f - c * e) * inv,
+        c1 * inv, (a * k - c * g) * inv, (c * d - a * f) * inv,
+        c2 * inv, (b * g - a * h) * inv, (a * e - b * d) * inv
+    };
+    for (int i = 0; i < 3; i++)
+    {
+        for (int j = 0; j < 3; j++)
+            out[4 * i + j] = static_cast<float>(r[3 * i + j]);
+        out[4 * i + 3] = 0.0f;
+    }
+    for (int j = 0; j < 3; j++)
+        out[12 + j] = static_cast<float>(-(m[12] * r[j] + m[13] * r[3 + j] + m[14] * r[6 + j]));
+    out[15] = 1.0f;
+}
+
+} // namespace
+
+SklEvaluator::SklEvaluator()
+    : num_bones_(0), any_dirty_(false)
+{
+}
+
+MStatus SklEvaluator::setSkeleton(const SklData& skeleton)
+{
+    int num_bones = static_cast<int>(skeleton.bones.size());
+
+    // children lists, in the bones order
+    std::vector<int> first_child(num_bones + 1, 0);
+    std::vector<int> children(num_bones);
+    std::vector<int> roots;
+    for (int i = 0; i < num_bones; i++)
+    {
+        int parent = skeleton.bones[i].parent;
+        if (parent < -1 || parent >= num_bones)
+            FAILURE("SklEvaluator: a parent is out of the skeleton");
+        if (parent == -1 || parent == i)
+            roots.push_back(i);
+        else
+            first_child[parent + 1]++;
+    }
+    for (int i = 0; i < num_bones; i++)
+        first_child[i + 1] += first_child[i];
+    std::vector<int> filled(first_child.begin(), first_child.end() - 1);
+    for (int i = 0; i < num_bones; i++)
+    {
+        int parent = skeleton.bones[i].parent;
+        if (parent != -1 && parent != i)
+            children[filled[parent]++] = i;
+    }
+
+    // depth first, each subtree ends up in a range
+    order_.clear();
+    order_.reserve(num_bones);
+    position_.assign(num_bones, -1);
+    parent_.assign(num_bones, -1);
+    subtree_end_.assign(num_bones, 0);
+    std::vector<int> stack;
+    for (size_t r = 0; r < roots.size(); r++)
+    {
+        stack.push_back(roots[r]);
+        while (!stack.empty())
+        {
+            int bone = stack.back();
+            stack.pop_back();
+            position_[bone] = static_cast<int>(order_.size());
+            order_.push_back(bone);
+            for (int c = first_child[bone + 1] - 1; c >= first_child[bone]; c--)
+                stack.push_back(children[c]);
+        }
+    }
+    if (static_cast<int>(order_.size()) != num_bones)
+        FAILURE("SklEvaluator: the parents make a loop");
+
+    for (int p = num_bones - 1; p >= 0; p--)
+    {
+        int bone = order_[p];
+        int parent = skeleton.bones[bone].parent;
+        parent_[p] = (parent == -1 || parent == bone) ? -1 : position_[parent];
+        if (subtree_end_[p] < p + 1)
+            subtree_end_[p] = p + 1;
+        if (parent_[p] >= 0 && subtree_end_[parent_[p]] < subtree_end_[p])
+            subtree_end_[parent_[p]] = subtree_end_[p];
+    }
+
+    num_bones_ = num_bones;
+    bind_local_.resize(16 * num_bones);
+    bind_.resize(16 * num_bones);
+    inverse_bind_.resize(16 * num_bones);
+    local_.resize(16 * num_bones);
+    world_.resize(16 * num_bones);
+
+    // version 3 is relative to the parents, the others are world matrices
+    bool relative = skeleton.version == 3;
+    float inverse_parent[16];
+    for (int p = 0; p < num_bones; p++)
+    {
+        const float* transform = &skeleton.bones[order_[p]].transform[0][0];
+        int parent = parent_[p];
+        if (relative)
+        {
+            memcpy(&bind_local_[16 * p], transform, 16 * sizeof(float));
+            if (parent < 0)
+                memcpy(&bind_[16 * p], transform, 16 * sizeof(float));
+            else
+                multiplyMatrices(transform, &bind_[16 * parent], &bind_[16 * p]);
+        }
+        else
+        {
+            memcpy(&bind_[16 * p], transform, 16 * sizeof(float));
+            if (parent < 0)
+            {
+                memcpy(&bind_local_[16 * p], transform, 16 * sizeof(float));
+            }
+            else
+            {
+                invert(&bind_[16 * parent], inverse_parent);
+                multiplyMatrices(transform, inverse_parent, &bind_local_[16 * p]);
+            }
+        }
+        invert(&bind_[16 * p], &inverse_bind_[16 * p]);
+    }
+
+    names_.resize(num_bones);
+    for (int p = 0; p < num_bones; p++)
+        names_[p] = skeleton.bones[order_[p]].name;
+
+    local_ = bind_local_;
+    world_ = bind_;
+    anm_bone_.assign(num_bones, -1);
+    dirty_.assign(num_bones, 0);
+    any_dirty_ = false;
+
+    return MS::kSuccess;
+}
+
+MStatus SklEvaluator::bindAnimation(const AnmData& animation)
+{
+    if (num_bones_ == 0)
+        FAILURE("SklEvaluator: bindAnimation() without a skeleton");
+
+    std::map<std::string, int> by_name;
+    std::map<int, int> by_hash;
+    int num_anm_bones = static_cast<int>(animation.bones.size()) < animation.num_bones
+                        ? static_cast<int>(animation.bones.size()) : animation.num_bones;
+    for (int j = 0; j < num_anm_bones; j++)
+    {
+        const AnmBone& bone = animation.bones[j];
+        if (bone.name_hash != 0)
+            by_hash.insert(std::make_pair(bone.name_hash, j));
+        else
+            by_name.insert(std::make_pair(std::string(bone.name), j));
+    }
+
+    int num_bound = 0;
+    for (int p = 0; p < num_bones_; p++)
+    {
+        std::map<std::string, int>::const_iterator name = by_name.find(names_[p]);
+        std::map<int, int>::const_iterator hash = by_hash.find(hashName(names_[p].c_str()));
+        if (name != by_name.end())
+            anm_bone_[p] = name->second;
+        else if (hash != by_hash.end())
+            anm_bone_[p] = hash->second;
+        else
+            anm_bone_[p] = -1;
+        if (anm_bone_[p] >= 0)
+            num_bound++;
+    }
+
+    if (num_bound < num_anm_bones)
+        MGlobal::displayInfo(MString("SklEvaluator: ") + (num_anm_bones - num_bound) + " of " + num_anm_bones +
+                             " anm bones are not in the skeleton");
+    return MS::kSuccess;
+}
+
+void SklEvaluator::animatedLocals(const AnmData& animation, int frame, float* poses, float* locals) const
+{
+    for (int p = 0; p < num_bones_; p++)
+    {
+        float* pose = poses + kPoseSize * p;
+        if (anm_bone_[p] < 0)
+        {
+            pose[0] = pose[1] = pose[2] = 0.0f;
+            pose[3] = 1.0f;
+            pose[4] = pose[5] = pose[6] = 0.0f;
+            continue;
+        }
+        AnmPos pos;
+        animation.getPose(anm_bone_[p], frame, pos);
+        memcpy(pose, pos.rot, 4 * sizeof(float));
+        pose[4] = pos.x;
+        pose[5] = pos.y;
+        pose[6] = pos.z;
+    }
+
+    if (num_bones_ > 0)
+        bonesToMatrices<KeepHand>(poses, poses + 4, kPoseSize * sizeof(float), num_bones_, locals, 16 * sizeof(float));
+
+    // the bones without animation stay in their bind pose
+    for (int p = 0; p < num_bones_; p++)
+    {
+        if (anm_bone_[p] < 0)
+            memcpy(locals + 16 * p, &bind_local_[16 * p], 16 * sizeof(float));
+    }
+}
+
+void SklEvaluator::propagate(const float* locals, float* worlds, int begin, int end) const
+{
+    for (int p = begin; p < end; p++)
+    {
+        int parent = parent_[p];
+        if (parent < 0)
+            memcpy(worlds + 16 * p, locals + 16 * p, 16 * sizeof(float));
+        else
+            multiplyMatrices(locals + 16 * p, worlds + 16 * parent, worlds + 16 * p);
+    }
+}
+
+MStatus SklEvaluator::evaluate(const AnmData& animation, int frame)
+{
+    if (static_cast<int>(anm_bone_.size()) != num_bones_)
+        FAILURE("SklEvaluator: evaluate() without a skeleton");
+    if (frame < 0 || frame >= animation.num_frames)
+        FAILURE("SklEvaluator: the frame is out of the animation");
+
+    std::vector<float> poses(kPoseSize * num_bones_ + 1);
+    animatedLocals(animation, frame, &poses[0], local_.data());
+    propagate(local_.data(), world_.data(), 0, num_bones_);
+
+    dirty_.assign(num_bones_, 0);
+    any_dirty_ = false;
+    return MS::kSuccess;
+}
+
+MStatus SklEvaluator::evaluateFrames(const AnmData& animation, int first, int count, float* world_matrices,
+                                     bool parallel) const
+{
+    if (static_cast<int>(anm_bone_.size()) != num_bones_)
+        FAILURE("SklEvaluator: evaluateFrames() without a skeleton");
+    if (first < 0 || count < 0 || first > animation.num_frames - count)
+        FAILURE("SklEvaluator: the frames are out of the animation");
+
+#pragma omp parallel if(parallel)
+    {
+        std::vector<float> poses(kPoseSize * num_bones_ + 1);
+        AlignedArray<float> locals(16 * num_bones_ + 1);
+        AlignedArray<float> worlds(16 * num_bones_ + 1);
+
+#pragma omp for schedule(dynamic)
+        for (int i = 0; i < count; i++)
+        {
+            animatedLocals(animation, first + i, &poses[0], locals.data());
+            propagate(locals.data(), worlds.data(), 0, num_bones_);
+
+            float* out = world_matrices + static_cast<size_t>(i) * num_bones_ * 16;
+            for (int p = 0; p < num_bones_; p++)
+                memcpy(out + 16 * order_[p], &worlds[16 * p], 16 * sizeof(float));
+        }
+    }
+
+    return MS::kSuccess;
+}
+
+void SklEvaluator::setLocalPose(int bone, const float* rotation, const float* translation)
+{
+    int p = position_[bone];
+    bonesToMatrices<KeepHand>(rotation, translation, 0, 1, &local_[16 * p], 16 * sizeof(float));
+    dirty_[p] = 1;
+    any_dirty_ = true;
+}
+
+void SklEvaluator::update()
+{
+    if (!any_dirty_)
+        return;
+
+    // a changed bone takes its whole subtree, the changes inside are then done
+    int p = 0;
+    while (p < num_bones_)
+    {
+        if (!dirty_[p])
+        {
+            p++;
+            continue;
+        }
+        int end = subtree_end_[p];
+        propagate(local_.data(), world_.data(), p, end);
+        for (; p < end; p++)
+            dirty_[p] = 0;
+    }
+    any_dirty_ = false;
+}
+
+void SklEvaluator::skinningMatrices(float* matrices) const
+{
+    for (int p = 0; p < num_bones_; p++)
+        multiplyMatrices(&inverse_bind_[16 * p], &world_[16 * p], matrices + 16 * order_[p]);
+}
+
+} // namespace riot
@@ -0,0 +1,113 @@
+/*
+    Copyright 2011 Even Entem (alias ThiSpawn).
+
+    This file is part of Riot File Translator Plug-in for AutoDesk Maya.
+
+    Autodesk Maya's lib is under :
+    Copyright 1995, 2006, 2008 Autodesk, Inc. All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful, 
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef RIOT__SKLEVALUATOR_H
+#define RIOT__SKLEVALUATOR_H
+
+#include <string>
+#include <vector>
+
+#include <maya/MStatus.h>
+
+#include <AlignedArray.hpp>
+
+namespace riot {
+
+struct SklData;
+struct AnmData;
+
+// evaluates the world matrices of a skeleton without maya.
+// the bones are put once in depth first order, parents before their
+// children, so the subtree of a bone is a range of that order and only
+// the changed subtrees are evaluated again.
+// the matrices are in maya layout (16 floats, rotation in the upper 3x3,
+// translation on the last row, v * local * parent world).
+// not thread safe, use an evaluator per thread.
+class SklEvaluator
+{
+public:
+    SklEvaluator();
+
+    // orders the bones and caches their bind matrices and the inverses.
+    // the transforms of skl version 1 and 2 are world matrices, those of
+    // version 3 are relative to the parent.
+    MStatus setSkeleton(const SklData& skeleton);
+
+    // matches the bones of animation to the ones of the skeleton, by name,
+    // or by name hash for version 4. the bones it doesn't have keep their
+    // bind pose.
+    MStatus bindAnimation(const AnmData& animation);
+
+    // the local poses of a frame of the bound animation, then every world matrix
+    MStatus evaluate(const AnmData& animation, int frame);
+
+    // the world matrices of the frames [first, first + count), frame after
+    // frame, num_bones() * 16 floats per frame. the frames are split
+    // between threads with openmp when parallel.
+    MStatus evaluateFrames(const AnmData& animation, int first, int count, float* world_matrices,
+                           bool parallel = true) const;
+
+    // changes the local pose of a bone (rotation x y z w, translation),
+    // update() then evaluates its subtree again
+    void setLocalPose(int bone, const float* rotation, const float* translation);
+    // the world matrices of the changed subtrees
+    void update();
+
+    int numBones() const { return num_bones_; }
+    // the bones in evaluation order
+    const std::vector<int>& order() const { return order_; }
+
+    // 16 floats of a bone, in the skeleton order
+    const float* worldMatrix(int bone) const { return &world_[16 * position_[bone]]; }
+    const float* bindMatrix(int bone) const { return &bind_[16 * position_[bone]]; }
+    const float* inverseBindMatrix(int bone) const { return &inverse_bind_[16 * position_[bone]]; }
+
+    // inverse bind * world of every bone, in the skeleton order, for skinning
+    void skinningMatrices(float* matrices) const;
+
+private:
+    // local matrices of a frame, in evaluation order. poses is 7 floats of
+    // scratch per bone
+    void animatedLocals(const AnmData& animation, int frame, float* poses, float* locals) const;
+    // world matrices of the positions [begin, end) of the order
+    void propagate(const float* locals, float* worlds, int begin, int end) const;
+
+    int num_bones_;
+    std::vector<int> order_;        // position -> bone
+    std::vector<int> position_;     // bone -> position
+    std::vector<int> parent_;       // parent position, -1 for a root, by position
+    std::vector<int> subtree_end_;  // by position
+    std::vector<std::string> names_; // by position
+    std::vector<int> anm_bone_;     // anm bone of each position, -1 if none
+    std::vector<char> dirty_;       // by position
+    bool any_dirty_;
+
+    // 16 floats per position
+    AlignedArray<float> bind_local_;
+    AlignedArray<float> bind_;
+    AlignedArray<float> inverse_bind_;
+    AlignedArray<float> local_;
+    AlignedArray<float> world_;
+};
+
+} // namespace riot
+
+#endif
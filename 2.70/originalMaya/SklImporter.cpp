@@ -31,6 +31,7 @@
 #include <maya_misc.h>
 
 #include <SklReader.h>
+#include <AssetCache.h>
 
 namespace riot {
 
@@ -87,7 +88,7 @@ MStatus SklImporter::reader(const MFileObject& file,
 
     SklReader *reader = new SklReader();
 
-    if (MStatus::kFailure == reader->read(fin))
+    if (MStatus::kFailure == AssetCache::importCache().read(*reader, fin, file_name.asChar()))
     {
         delete reader;
         FAILURE("SklImporter: reader->read(filename); failed");
@@ -32,6 +32,7 @@
 #include <maya/MQuaternion.h>
 
 #include <maya_misc.h>
+#include <BoneMatrices.h>
 
 namespace riot {
 
@@ -74,6 +75,7 @@ struct RawSklBone
     float ctz;
 };
 
+template <class Hand>
 MStatus SklReader::readBinary(istream& file)
 {
     // get length
@@ -95,20 +97,17 @@ MStatus SklReader::readBinary(istream& file)
     char* pname = pcopy + phead->size_after_array4;
     
     data_.bones.resize(num_bones);
+
+    // the matrices of all the bones in one pass, from the records in place
+    std::vector<float> matrices(static_cast<size_t>(num_bones) * 16);
+    if (num_bones > 0)
+        bonesToMatrices<Hand>(&raw_bone->q1, &raw_bone->tx, 0x64, num_bones, &matrices[0], 16 * sizeof(float));
     
     // get bones
     for (int i = 0; i < num_bones; i++)
     {
         SklBone bone;
-        
-        MVector translation = MVector(raw_bone->tx, raw_bone->ty, raw_bone->tz);
-        MTransformationMatrix transform;
-        transform.setTranslation(translation, MSpace::kWorld);
-        transform.setRotationQuaternion(raw_bone->q1, raw_bone->q2, raw_bone->q3, raw_bone->q4, MSpace::kWorld);
-        MMatrix mat = transform.asMatrix();
-        for (int j = 0; j < 4; j++)
-            for (int k = 0; k < 4; k++)
-                bone.transform[j][k] = static_cast<float>(mat[j][k]);
+        memcpy(bone.transform, &matrices[i * 16], sizeof(bone.transform));
         
         char* c = bone.name;
         int count = 0;
@@ -142,6 +141,7 @@ MStatus SklReader::readBinary(istream& file)
     return MS::kSuccess;
 }
 
+template <class Hand>
 MStatus SklReader::read(istream& file)
 {
     // get length
@@ -194,6 +194,7 @@ MStatus SklReader::read(istream& file)
             bone.transform[1][3] = 0.0f;
             bone.transform[2][3] = 0.0f;
             bone.transform[3][3] = 1.0f;
+            Hand::matrix(bone.transform);
             data_.bones.push_back(bone);
         }
 
@@ -233,16 +234,21 @@ MStatus SklReader::read(istream& file)
     {
         data_.version = 3;
         MGlobal::displayInfo("SklReader: skl is of type raw, this support is in beta test, report any problems.");
-        readBinary(file);
+        readBinary<Hand>(file);
     }
     else
         FAILURE("SklReader: magic is wrong!");
-    
-    data_.switchHand();
 
     return MS::kSuccess;
 }
 
+template MStatus SklReader::readBinary<SwitchHand>(istream& file);
+template MStatus SklReader::readBinary<KeepHand>(istream& file);
+template MStatus SklReader::read<SwitchHand>(istream& file);
+template MStatus SklReader::read<KeepHand>(istream& file);
+
+#ifndef RIOT_HEADLESS
+
 MStatus SklReader::loadData()
 {
     // the bones don't need to be in hierarchical order
@@ -309,16 +315,17 @@ MStatus SklReader::templateUnused()
 {
     if (data_.version == 2)
     {
-        int num_influences = data_.num_indices;
+        // the bones the skn uses, in one pass over the indices
+        std::vector<char> influences(data_.num_bones, 0);
+        for (int j = 0; j < data_.num_indices; j++)
+        {
+            int bone = data_.skn_indices[j];
+            if (bone >= 0 && bone < data_.num_bones)
+                influences[bone] = 1;
+        }
         for (int i = 0; i < data_.num_bones; i++)
         {
-            int j = 0;
-            for (; j < num_influences; j++)
-            {
-                if (data_.skn_indices[j] == static_cast<int>(i))
-                    break;
-            }
-            if (j != num_influences)
+            if (influences[i])
                 continue;
             
             MFnIkJoint joint(data_.joints[i]);
@@ -333,5 +340,7 @@ MStatus SklReader::templateUnused()
     return MS::kSuccess;
 }
 
+#endif // RIOT_HEADLESS
+
 } // namespace riot
 
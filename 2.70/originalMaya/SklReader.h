@@ -28,14 +28,18 @@
 #include <maya/MIOStream.h>
 
 #include <SklData.hpp>
+#include <Handedness.hpp>
 
 namespace riot {
 
 class SklReader
 {
 public:
-    MStatus readBinary(istream& file);
-    MStatus read(istream& file);
+    // Hand is SwitchHand or KeepHand, see Handedness.hpp
+    template <class Hand> MStatus readBinary(istream& file);
+    template <class Hand> MStatus read(istream& file);
+    MStatus readBinary(istream& file) { return readBinary<SwitchHand>(file); }
+    MStatus read(istream& file) { return read<SwitchHand>(file); }
     MStatus loadData();
     MStatus templateUnused();
 
@@ -36,10 +36,9 @@
 
 namespace riot {
 
+template <class Hand>
 MStatus SklWriter::write(ostream& file)
 {
-    data_.switchHand();
-
     // magic
     char magic[9] = "r3d2sklt";
     file.write(magic, 8);
@@ -62,6 +61,7 @@ MStatus SklWriter::write(ostream& file)
     for (int i = 0; i < num_bones; i++)
     {
         SklBone bone = data_.bones[i];
+        Hand::matrix(bone.transform);
         file.write(reinterpret_cast<char*>(&bone), SklBone::kSizeWithoutMatrix);
         for (int j = 0; j < 3; j++)
             for (int k = 0; k < 4; k++)
@@ -83,6 +83,11 @@ MStatus SklWriter::write(ostream& file)
     return MS::kSuccess;
 }
 
+template MStatus SklWriter::write<SwitchHand>(ostream& file);
+template MStatus SklWriter::write<KeepHand>(ostream& file);
+
+#ifndef RIOT_HEADLESS
+
 MStatus SklWriter::dumpData()
 {
     MStatus status;
@@ -149,5 +154,7 @@ MStatus SklWriter::dumpData()
     return MS::kSuccess;
 }
 
+#endif // RIOT_HEADLESS
+
 } // namespace riot
 
@@ -28,13 +28,17 @@
 #include <maya/MIOStream.h>
 
 #include <SklData.hpp>
+#include <Handedness.hpp>
 
 namespace riot {
 
 class SklWriter
 {
 public:
-    MStatus write(ostream& file);
+    // Hand is SwitchHand or KeepHand, see Handedness.hpp
+    // data_ is left untouched, so it can be written more than once
+    template <class Hand> MStatus write(ostream& file);
+    MStatus write(ostream& file) { return write<SwitchHand>(file); }
     MStatus dumpData();
 
     SklData data_;
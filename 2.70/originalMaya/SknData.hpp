@@ -22,12 +22,16 @@
 #ifndef RIOT__SKNDATA_HPP
 #define RIOT__SKNDATA_HPP
 
+#include <string.h>
 #include <vector>
 #include <map>
 
 #include <maya/MMatrix.h>
 #include <maya/MIntArray.h>
 
+#include <AlignedArray.hpp>
+#include <Handedness.hpp>
+
 namespace riot {
 
 struct SknMaterial
@@ -44,6 +48,8 @@ struct SknMaterial
     int num_indices;
 };
 
+// vertex as it is laid out in the file.
+// in memory the vertices are kept as streams, see SknVertexStreams.
 struct SknVtx
 {
     static const int kSizeInFile = 0x34;
@@ -65,23 +71,127 @@ struct SknVtx
     float normal[3];
     float U;
     float V;
-    int skl_indices[4];
-    int uv_index;
-    int dupe_data_index;
+};
+
+// one stream per vertex attribute, so a pass over one of them
+// doesn't drag the others through the cache.
+// positions have a 4th component set to 1 so they can be handed to
+// MFloatPointArray as they are, normals go to MVectorArray the same way.
+struct SknVertexStreams
+{
+    void resize(int num_vertices)
+    {
+        positions.resize(4 * num_vertices);
+        normals.resize(3 * num_vertices);
+        u.resize(num_vertices);
+        v.resize(num_vertices);
+        skn_indices.resize(4 * num_vertices);
+        weights.resize(4 * num_vertices);
+        for (int i = 0; i < num_vertices; i++)
+            positions[4 * i + 3] = 1.0f;
+    }
+
+    int size() const { return u.size(); }
+
+    void setVtx(int i, const SknVtx& vtx)
+    {
+        positions[4 * i] = vtx.x;
+        positions[4 * i + 1] = vtx.y;
+        positions[4 * i + 2] = vtx.z;
+        for (int j = 0; j < 3; j++)
+            normals[3 * i + j] = vtx.normal[j];
+        u[i] = vtx.U;
+        v[i] = vtx.V;
+        for (int j = 0; j < 4; j++)
+        {
+            skn_indices[4 * i + j] = static_cast<unsigned char>(vtx.skn_indices[j]);
+            weights[4 * i + j] = vtx.weights[j];
+        }
+    }
+
+    SknVtx getVtx(int i) const
+    {
+        SknVtx vtx;
+        vtx.x = positions[4 * i];
+        vtx.y = positions[4 * i + 1];
+        vtx.z = positions[4 * i + 2];
+        for (int j = 0; j < 3; j++)
+            vtx.normal[j] = normals[3 * i + j];
+        vtx.U = u[i];
+        vtx.V = v[i];
+        for (int j = 0; j < 4; j++)
+        {
+            vtx.skn_indices[j] = static_cast<char>(skn_indices[4 * i + j]);
+            vtx.weights[j] = weights[4 * i + j];
+        }
+        return vtx;
+    }
+
+    AlignedArray<float> positions; // x y z 1
+    AlignedArray<float> normals; // x y z
+    AlignedArray<float> u;
+    AlignedArray<float> v; // as in the file (not flipped for maya)
+    AlignedArray<unsigned char> skn_indices; // 4 per vertex
+    AlignedArray<float> weights; // 4 per vertex
 };
 
 class SknData
 {
 public:
+    SknData()
+        : version(0), num_vtxs(0), num_indices(0), num_final_vtxs(0), index_view(0)
+    {
+        memset(endTab, 0, sizeof(endTab));
+    }
+
+    // a copy owns its indices, the view of other may point into the file
+    // held by its reader or into other itself
+    SknData(const SknData& other)
+        : version(0), num_vtxs(0), num_indices(0), num_final_vtxs(0), index_view(0)
+    {
+        *this = other;
+    }
+
+    SknData& operator=(const SknData& other)
+    {
+        if (this == &other)
+            return *this;
+        version = other.version;
+        num_vtxs = other.num_vtxs;
+        num_indices = other.num_indices;
+        num_final_vtxs = other.num_final_vtxs;
+        if (other.index_view && (other.indices.empty() || other.index_view != &other.indices[0]))
+            indices.assign(other.index_view, other.index_view + other.num_indices);
+        else
+            indices = other.indices;
+        materials = other.materials;
+        vertices = other.vertices;
+        memcpy(endTab, other.endTab, sizeof(endTab));
+        // the old view points into another file or a freed buffer
+        index_view = indices.empty() ? 0 : &indices[0];
+        return *this;
+    }
+
+    // the view points at indices, which first get what it viewed when
+    // it was somewhere else
+    void ownIndices()
+    {
+        if (index_view && (indices.empty() || index_view != &indices[0]))
+            indices.assign(index_view, index_view + num_indices);
+        index_view = indices.empty() ? 0 : &indices[0];
+    }
+
     void switchHand()
     {
-        int vertices_size = static_cast<int>(vertices.size());
+        int vertices_size = vertices.size();
+        float* positions = vertices.positions.data();
+        float* normals = vertices.normals.data();
         for (int i = 0; i < vertices_size; i++)
         {
-            SknVtx& vtx = vertices.at(i);
-            vtx.x = -vtx.x;
-            vtx.normal[1] = -vtx.normal[1];
-            vtx.normal[2] = -vtx.normal[2];
+            float* position = positions + 4 * i;
+            float* normal = normals + 3 * i;
+            SwitchHand::position(position[0], position[1], position[2]);
+            SwitchHand::normal(normal[0], normal[1], normal[2]);
         }
     }
 
@@ -91,8 +201,13 @@ public:
     int num_final_vtxs;
     std::vector<USHORT> indices;
     std::vector<SknMaterial> materials;
-    std::vector<SknVtx> vertices;
+    SknVertexStreams vertices;
     int endTab[3];
+
+    // filled by SknReader, it points into the file held by the reader.
+    // a copy is only made (into indices) when bad triangles are removed,
+    // or when the SknData is copied.
+    const USHORT* index_view;
 };
 
 } // namespace riot
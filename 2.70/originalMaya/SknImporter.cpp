@@ -30,6 +30,7 @@
 
 #include <SknReader.h>
 #include <SklReader.h>
+#include <AssetCache.h>
 #include <maya_misc.h>
 
 namespace riot {
@@ -103,10 +104,6 @@ MStatus SknImporter::reader(const MFileObject& file,
         file_full_base_name = file_full_base_name.substringW(0, rindex - 1);
     const MString skl_file_name = file_full_base_name + ".skl";
 
-    ifstream fin_skn(skn_file_name.asChar(), ios::binary);
-    if (!fin_skn)
-        FAILURE("SknImporter: " + skn_file_name + " : could not be opened for reading");
-
     SknReader *skn_reader = new SknReader();
 
     SklReader *skl_reader = NULL;
@@ -122,7 +119,7 @@ MStatus SknImporter::reader(const MFileObject& file,
         skl_reader = new SklReader();
         skl_data = &(skl_reader->data_);
 
-        if (MStatus::kFailure == skl_reader->read(fin_skl))
+        if (MStatus::kFailure == AssetCache::importCache().read(*skl_reader, fin_skl, skl_file_name.asChar()))
         {
             delete skn_reader;
             delete skl_reader;
@@ -135,7 +132,7 @@ MStatus SknImporter::reader(const MFileObject& file,
             FAILURE("SknImporter: skl_reader->loadData(); failed");
         }
     }
-    if (MStatus::kFailure == skn_reader->read(fin_skn))
+    if (MStatus::kFailure == AssetCache::importCache().read(*skn_reader, skn_file_name.asChar()))
     {
         delete skn_reader;
         if (skl_reader)
@@ -160,7 +157,6 @@ MStatus SknImporter::reader(const MFileObject& file,
         }
     }
 
-    fin_skn.close();
     delete skn_reader;
     if (skl_reader)
     {
@@ -42,43 +42,81 @@
 #include <maya/MSelectionList.h>
 #include <maya/MFnSingleIndexedComponent.h>
 #include <maya/MDagPath.h>
+#include <maya/MTimer.h>
 
 #include <maya_misc.h>
+#include <TriangleFilter.h>
+#include <BoneIndexMap.h>
 
 namespace riot {
 
+template <class Hand>
 MStatus SknReader::read(istream& file)
 {
     // get length
-    int minlen = 8;
     file.seekg (0, ios::end);
     int length = file.tellg();
     file.seekg (0, ios::beg);
 
+    // check minimum length
+    if (length < 8)
+        FAILURE("SknReader: the file is empty!");
+
+    // copy in mem with a single read, then parse it in place
+    mapped_file_.close();
+    file_buffer_.resize(length);
+    file.read(&file_buffer_[0], length);
+    if (file.gcount() != length)
+        FAILURE("SknReader: unexpected end of file");
+
+    return parse<Hand>(&file_buffer_[0], length);
+}
+
+template <class Hand>
+MStatus SknReader::read(const char* file_name)
+{
+    file_buffer_.clear();
+    if (!mapped_file_.open(file_name))
+        FAILURE(MString("SknReader: ") + file_name + " : could not be mapped for reading");
+
+    return parse<Hand>(mapped_file_.data(), mapped_file_.size());
+}
+
+template <class Hand>
+MStatus SknReader::parse(const char* buffer, int length)
+{
+    int minlen = 8;
+
     // check minimum length
     if (length < minlen)
         FAILURE("SknReader: the file is empty!");
 
+    const char* p = buffer;
+
     // check magic
     int magic;
-    file.read(reinterpret_cast<char*>(&magic), 4);
+    memcpy(&magic, p, 4);
+    p += 4;
     if (magic != 0x00112233)
         FAILURE("SknReader: magic is wrong!");
 
     // get version
     USHORT version;
-    file.read(reinterpret_cast<char*>(&version), 2);
+    memcpy(&version, p, 2);
+    p += 2;
     if (version > 2)
         FAILURE("SknReader: skn type not supported, \n please report that to ThiSpawn");
     data_.version = version;
 
     // get num obj
     USHORT num_objects;
-    file.read(reinterpret_cast<char*>(&num_objects), 2);
+    memcpy(&num_objects, p, 2);
+    p += 2;
     if (num_objects != 1)
         FAILURE("SknReader: more than 1 or no objects in the file.");
 
     // get materials
+    data_.materials.clear();
     if (version == 1 || version == 2)
     {
         minlen += 4;
@@ -86,17 +124,18 @@ MStatus SknReader::read(istream& file)
             FAILURE("SknReader: unexpected end of file");
 
         int num_materials;
-        file.read(reinterpret_cast<char*>(&num_materials), 4);
+        memcpy(&num_materials, p, 4);
+        p += 4;
 
-        minlen += SknMaterial::kSizeInFile * num_materials;
-        if (length < minlen)
+        if (num_materials < 0 || num_materials > (length - minlen) / SknMaterial::kSizeInFile)
             FAILURE("SknReader: unexpected end of file");
+        minlen += SknMaterial::kSizeInFile * num_materials;
 
+        data_.materials.resize(num_materials);
         for (int i = 0; i < num_materials; i++)
         {
-            SknMaterial material;
-            file.read(reinterpret_cast<char*>(&material), SknMaterial::kSizeInFile);
-            data_.materials.push_back(material);
+            memcpy(&data_.materials[i], p, SknMaterial::kSizeInFile);
+            p += SknMaterial::kSizeInFile;
         }
     }
 
@@ -107,67 +146,91 @@ MStatus SknReader::read(istream& file)
 
     // get nums
     int num_indices;
-    file.read(reinterpret_cast<char*>(&num_indices), 4);
+    memcpy(&num_indices, p, 4);
+    p += 4;
     data_.num_indices = num_indices;
     int num_vertices;
-    file.read(reinterpret_cast<char*>(&num_vertices), 4);
+    memcpy(&num_vertices, p, 4);
+    p += 4;
     data_.num_vtxs = num_vertices;
     data_.num_final_vtxs = num_vertices;
 
     if (num_indices % 3 != 0)
         FAILURE("SknReader: num_indices % 3 != 0 ...");
 
-    // check minimum length
+    // check minimum length, all at once so nothing has to be checked later
+    if (num_indices < 0 || num_vertices < 0 ||
+        num_indices > (length - minlen) / 2 ||
+        num_vertices > (length - minlen - 2 * num_indices) / SknVtx::kSizeInFile)
+        FAILURE("SknReader: unexpected end of file");
     minlen += 2 * num_indices + SknVtx::kSizeInFile * num_vertices;
-    if (length < minlen)
+    if (version == 2 && length < minlen + 12)
         FAILURE("SknReader: unexpected end of file");
-    
 
     // get indices
+    // they are used in place unless a badly built triangle has to be removed.
+    const USHORT* file_indices = reinterpret_cast<const USHORT*>(p);
+    p += 2 * num_indices;
+
+    data_.indices.clear();
+    data_.index_view = file_indices;
     int num_triangles = num_indices / 3;
-    for (int i = 0; i < num_triangles; i++)
+    int num_bad_triangles = countBadTriangles(file_indices, num_triangles, num_vertices);
+    if (num_bad_triangles)
     {
-        USHORT indices[3];
-        file.read(reinterpret_cast<char*>(&indices), 6);
-        // check if that can build a triangle
-        if (indices[0] == indices[1] ||
-            indices[0] == indices[2] ||
-            indices[1] == indices[2] ||
-            indices[0] < 0 ||
-            indices[0] >= data_.num_vtxs ||
-            indices[1] < 0 ||
-            indices[1] >= data_.num_vtxs ||
-            indices[2] < 0 ||
-            indices[2] >= data_.num_vtxs)
-        {
-            MGlobal::displayWarning("SknReader: input mesh has a badly built triangle, removing it...");
-            data_.num_indices -= 3; 
-        }
-        else
-        {
-            data_.indices.push_back(indices[0]);
-            data_.indices.push_back(indices[1]);
-            data_.indices.push_back(indices[2]);
-        }
+        MGlobal::displayWarning(MString("SknReader: input mesh has ") + num_bad_triangles
+                                + " badly built triangle(s), removing them...");
+        data_.indices.resize(num_indices);
+        filterTriangles(file_indices, num_triangles, num_vertices, &data_.indices[0]);
+        data_.num_indices -= 3 * num_bad_triangles;
+        data_.indices.resize(data_.num_indices);
+        data_.index_view = 0;
+        data_.ownIndices();
     }
 
     // get vertices
+    // decoded straight into the streams, converting the handedness on the way
+    data_.vertices.resize(num_vertices);
+    float* positions = data_.vertices.positions.data();
+    float* normals = data_.vertices.normals.data();
+    float* u = data_.vertices.u.data();
+    float* v = data_.vertices.v.data();
+    unsigned char* skn_indices = data_.vertices.skn_indices.data();
+    float* weights = data_.vertices.weights.data();
     for (int i = 0; i < num_vertices; i++)
     {
         SknVtx vtx;
-        file.read(reinterpret_cast<char*>(&vtx), SknVtx::kSizeInFile);
-        data_.vertices.push_back(vtx);
+        memcpy(&vtx, p, SknVtx::kSizeInFile);
+        p += SknVtx::kSizeInFile;
+
+        Hand::position(vtx.x, vtx.y, vtx.z);
+        Hand::normal(vtx.normal[0], vtx.normal[1], vtx.normal[2]);
+        positions[4 * i] = vtx.x;
+        positions[4 * i + 1] = vtx.y;
+        positions[4 * i + 2] = vtx.z;
+        normals[3 * i] = vtx.normal[0];
+        normals[3 * i + 1] = vtx.normal[1];
+        normals[3 * i + 2] = vtx.normal[2];
+        u[i] = vtx.U;
+        v[i] = vtx.V;
+        memcpy(skn_indices + 4 * i, vtx.skn_indices, 4);
+        memcpy(weights + 4 * i, vtx.weights, 16);
     }
 
     // get endtab
     if (version == 2)
-        file.read(reinterpret_cast<char*>(&(data_.endTab)), 12);
-
-    data_.switchHand();
+        memcpy(data_.endTab, p, 12);
 
     return MS::kSuccess;
 }
 
+template MStatus SknReader::read<SwitchHand>(istream& file);
+template MStatus SknReader::read<KeepHand>(istream& file);
+template MStatus SknReader::read<SwitchHand>(const char* file_name);
+template MStatus SknReader::read<KeepHand>(const char* file_name);
+
+#ifndef RIOT_HEADLESS
+
 MStatus SknReader::loadData(MString& name, bool use_normals, SklData* skl_data)
 {
     MFnSkinCluster fn_skin_cluster;
@@ -177,29 +240,29 @@ MStatus SknReader::loadData(MString& name, bool use_normals, SklData* skl_data)
     MFnSet fn_set;
     MStatus status;
     MFnMesh mesh;
-    MFloatPointArray vertex_array;
+    const SknVertexStreams& vertices = data_.vertices;
     int num_triangles = data_.num_indices / 3;
-    MIntArray poly_counts(num_triangles);
+    MIntArray poly_counts(num_triangles, 3);
     MIntArray poly_connects(data_.num_indices);
-    MFloatArray u_array(data_.num_vtxs);
-    MFloatArray v_array(data_.num_vtxs);
-    MVectorArray normals(data_.num_vtxs);
     MIntArray normals_indices(data_.num_vtxs);
     MDagPath mesh_dag_path;
 
     // set indices data
-    for (int i = 0; i < num_triangles; i++)
-        poly_counts[i] = 3;
-
     for (int i = 0; i < data_.num_indices; i++)
-        poly_connects[i] = data_.indices[i];
+        poly_connects[i] = data_.index_view[i];
 
     // set vertices data
+    // the streams have the layout maya expects, so they are copied in bulk
+    MFloatPointArray vertex_array(reinterpret_cast<const float (*)[4]>(vertices.positions.data()),
+                                  data_.num_vtxs);
+    MVectorArray normals(reinterpret_cast<const float (*)[3]>(vertices.normals.data()),
+                         data_.num_vtxs);
+    MFloatArray u_array(vertices.u.data(), data_.num_vtxs);
+    MFloatArray v_array(data_.num_vtxs);
     for (int i = 0; i < data_.num_vtxs; i++)
     {
-        SknVtx vtx = data_.vertices[i];
-        u_array[i] = vtx.U;
-        v_array[i] = 1 - vtx.V;
+        v_array[i] = 1 - vertices.v[i];
+        normals_indices[i] = i;
         if (u_array[i] > 1)
             MGlobal::displayWarning(MString("SknReader: U out of bound (>1): ") + i);
         if (u_array[i] < 0)
@@ -208,9 +271,6 @@ MStatus SknReader::loadData(MString& name, bool use_normals, SklData* skl_data)
             MGlobal::displayWarning(MString("SknReader: V out of bound (>1): ") + i);
         if (v_array[i] < 0)
             MGlobal::displayWarning(MString("SknReader: V out of bound (<0): ") + i);
-        vertex_array.append(vtx.x, vtx.y, vtx.z);
-        normals[i] = MVector(vtx.normal[0], vtx.normal[1], vtx.normal[2]);
-        normals_indices[i] = static_cast<int>(i);
     }
 
     //create mesh
@@ -385,6 +445,9 @@ MStatus SknReader::loadData(MString& name, bool use_normals, SklData* skl_data)
     
     skl_data->joints;
 
+    // the bind : the skin cluster, then its influences by skn index
+    MTimer bind_timer;
+    bind_timer.beginTimer();
     MSelectionList selectList;
     selectList.add(mesh_dag_path);
     for (int i = 0; i < skl_data->num_indices; i++)
@@ -415,21 +478,19 @@ MStatus SknReader::loadData(MString& name, bool use_normals, SklData* skl_data)
         FAILURE("SknReader: influences_dag_path.length() != skl_data->num_indices");
 
     int num_influences = skl_data->num_indices;
+    BoneIndexMap influence_indices(influences_dag_path);
     for (int i = 0; i < num_influences; i++)
     {
-        MDagPath jointPath = skl_data->joints[skl_data->skn_indices[i]];
-        int j = 0;
-        for (; j < num_influences; j++)
-        {
-            if (influences_dag_path[j] == jointPath)
-                break;
-        }
-        if (j == static_cast<int>(influences_dag_path.length()))
+        int j = influence_indices.find(skl_data->joints[skl_data->skn_indices[i]]);
+        if (j < 0)
             FAILURE("SknReader: unable to find a bound bone.\
                         this error should not happen!");
         
         influenceIndicesBySknId[i] = j;
     }
+    bind_timer.endTimer();
+    MGlobal::displayInfo(MString("SknReader: ") + num_influences + " influences of " + skl_data->num_bones +
+                         " bones bound in " + bind_timer.elapsedTime() * 1000.0 + " ms");
 
     MFnSingleIndexedComponent fn_comp;
     MObject vtx_comp = fn_comp.create(MFn::kMeshVertComponent);
@@ -449,13 +510,11 @@ MStatus SknReader::loadData(MString& name, bool use_normals, SklData* skl_data)
 
     for (int i = 0; i < data_.num_vtxs; i++)
     {
-        SknVtx vtx = data_.vertices[i];
-
         for (int j = 0; j < 4; j++)
         {
-            double weight = vtx.weights[j];
+            double weight = vertices.weights[4 * i + j];
             
-            int n = vtx.skn_indices[j];
+            int n = vertices.skn_indices[4 * i + j];
             if (weight != 0)
                 values[i * num_influences + n] = weight;
 
@@ -476,5 +535,7 @@ MStatus SknReader::loadData(MString& name, bool use_normals, SklData* skl_data)
     return MS::kSuccess;
 }
 
+#endif // RIOT_HEADLESS
+
 } // namespace riot
 
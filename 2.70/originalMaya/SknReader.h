@@ -32,6 +32,8 @@
 
 #include <SklData.hpp>
 #include <SknData.hpp>
+#include <MappedFile.h>
+#include <Handedness.hpp>
 
 #ifndef nullptr
 #define nullptr 0
@@ -42,7 +44,11 @@ namespace riot {
 class SknReader
 {
 public:
-    MStatus read(istream& file);
+    // Hand is SwitchHand or KeepHand, see Handedness.hpp
+    template <class Hand> MStatus read(istream& file);
+    template <class Hand> MStatus read(const char* file_name); // mapped, no copy of the file
+    MStatus read(istream& file) { return read<SwitchHand>(file); }
+    MStatus read(const char* file_name) { return read<SwitchHand>(file_name); }
     MStatus loadData(MString& name,
                         bool use_normals = true,
                         SklData* skl_data = nullptr);
@@ -50,6 +56,11 @@ public:
     SknData data_;
 
 private:
+    template <class Hand> MStatus parse(const char* buffer, int length);
+
+    MappedFile mapped_file_;
+    std::vector<char> file_buffer_; // used when reading from a stream
+
     MIntArray poly_counts;
     MIntArray poly_connects;
     MFloatArray u_array;
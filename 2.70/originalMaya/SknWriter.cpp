@@ -22,6 +22,8 @@
 
 #include <SknWriter.h>
 
+#include <cmath>
+#include <string.h>
 #include <set>
 
 #include <maya/MGlobal.h>
@@ -42,62 +44,113 @@
 #include <maya/MPointArray.h>
 #include <maya/MPoint.h>
 #include <maya/MVector.h>
+#include <maya/MTimer.h>
 
 #include <maya_misc.h>
 #include <SknData.hpp>
+#include <BoneIndexMap.h>
+#include <SkinWeights.h>
+#include <VertexCache.h>
 
 namespace riot {
 
-MStatus SknWriter::write(ostream& file)
+namespace {
+
+// a vertex plus what dumpData needs to find the duplicates made for UVs
+struct SknExportVtx
+    : public SknVtx
+{
+    int uv_index;
+    int maya_index;
+};
+
+} // namespace
+
+int SknWriter::serializedSize() const
 {
-    data_.switchHand();
+    return 4 + 2 + 2 // magic, version, num objects
+           + 4 + static_cast<int>(data_.materials.size()) * SknMaterial::kSizeInFile
+           + 4 + 4 // num indices, num vertices
+           + data_.num_indices * 2
+           + data_.num_vtxs * SknVtx::kSizeInFile;
+}
+
+template <class Hand>
+MStatus SknWriter::write(char* buffer, int buffer_size)
+{
+    int num_materials = static_cast<int>(data_.materials.size());
+    if (num_materials > 2 || num_materials < 1)
+        FAILURE("SknWriter: num_materials < 1 || > 2");
+
+    int num_indices = data_.num_indices;
+    if (num_indices % 3 != 0)
+        FAILURE("SknWriter: num_indices % 3 != 0 ...");
+
+    int num_vertices = data_.num_vtxs;
+    if (static_cast<int>(data_.indices.size()) < num_indices || data_.vertices.size() < num_vertices)
+        FAILURE("SknWriter: the counts don't match the data");
+
+    if (buffer_size < serializedSize())
+        FAILURE("SknWriter: the buffer is too small");
+
+    char* out = buffer;
 
     // magic
     int magic = 0x00112233;
-    file.write(reinterpret_cast<char*>(&magic), 4);
+    memcpy(out, &magic, 4);
+    out += 4;
 
     // set version
     USHORT version = 1;
-    file.write(reinterpret_cast<char*>(&version), 2);
+    memcpy(out, &version, 2);
+    out += 2;
 
     // set num obj
     USHORT num_objects = 1;
-    file.write(reinterpret_cast<char*>(&num_objects), 2);
+    memcpy(out, &num_objects, 2);
+    out += 2;
 
     // set materials
-    int num_materials = static_cast<int>(data_.materials.size());
-    file.write(reinterpret_cast<char*>(&num_materials), 4);
+    memcpy(out, &num_materials, 4);
+    out += 4;
     for (int i = 0; i < num_materials; i++)
     {
-        SknMaterial material = data_.materials.at(i);
-        file.write(reinterpret_cast<char*>(&material), SknMaterial::kSizeInFile);
+        memcpy(out, &data_.materials[i], SknMaterial::kSizeInFile);
+        out += SknMaterial::kSizeInFile;
     }
 
-    if (num_materials > 2 || num_materials < 1)
-        FAILURE("SknWriter: num_materials < 1 || > 2");
-
     // set nums
-    int num_indices = data_.num_indices;
-    file.write(reinterpret_cast<char*>(&num_indices), 4);
-    int num_vertices = data_.num_vtxs;
-    file.write(reinterpret_cast<char*>(&num_vertices), 4);
-
-    if (num_indices % 3 != 0)
-        FAILURE("SknWriter: num_indices % 3 != 0 ...");
-
+    memcpy(out, &num_indices, 4);
+    out += 4;
+    memcpy(out, &num_vertices, 4);
+    out += 4;
 
     // set indices
-    for (int i = 0; i < num_indices; i++)
-    {
-        USHORT indice = data_.indices.at(i);
-        file.write(reinterpret_cast<char*>(&indice), 2);
-    }
-
-    // set vertices
+    if (num_indices)
+        memcpy(out, &data_.indices[0], num_indices * 2);
+    out += num_indices * 2;
+
+    // set vertices, straight from the streams
+    const float* positions = data_.vertices.positions.data();
+    const float* normals = data_.vertices.normals.data();
+    const float* u = data_.vertices.u.data();
+    const float* v = data_.vertices.v.data();
+    const unsigned char* skn_indices = data_.vertices.skn_indices.data();
+    const float* weights = data_.vertices.weights.data();
     for (int i = 0; i < num_vertices; i++)
     {
-        SknVtx vtx = data_.vertices.at(i);
-        file.write(reinterpret_cast<char*>(&vtx), SknVtx::kSizeInFile);
+        float position[3] = { positions[4 * i], positions[4 * i + 1], positions[4 * i + 2] };
+        Hand::position(position[0], position[1], position[2]);
+        float normal[3] = { normals[3 * i], normals[3 * i + 1], normals[3 * i + 2] };
+        Hand::normal(normal[0], normal[1], normal[2]);
+
+        memcpy(out, position, 12);
+        memcpy(out + 12, skn_indices + 4 * i, 4);
+        memcpy(out + 16, weights + 4 * i, 16);
+        memcpy(out + 32, normal, 12);
+        memcpy(out + 44, u + i, 4);
+        memcpy(out + 48, v + i, 4);
+        out += SknVtx::kSizeInFile;
     }
 
     /*
@@ -109,6 +162,105 @@ MStatus SknWriter::write(ostream& file)
     return MS::kSuccess;
 }
 
+template <class Hand>
+MStatus SknWriter::write(ostream& file)
+{
+    // the whole file is built in memory then written at once
+    std::vector<char> buffer(serializedSize());
+    if (MStatus::kSuccess != write<Hand>(&buffer[0], static_cast<int>(buffer.size())))
+        return MStatus::kFailure;
+
+    file.write(&buffer[0], buffer.size());
+    if (!file)
+        FAILURE("SknWriter: the file could not be written");
+
+    return MS::kSuccess;
+}
+
+template MStatus SknWriter::write<SwitchHand>(char* buffer, int buffer_size);
+template MStatus SknWriter::write<KeepHand>(char* buffer, int buffer_size);
+template MStatus SknWriter::write<SwitchHand>(ostream& file);
+template MStatus SknWriter::write<KeepHand>(ostream& file);
+
+MStatus SknWriter::optimizeVertexCache()
+{
+    if (static_cast<int>(data_.indices.size()) != data_.num_indices ||
+        static_cast<int>(data_.vertices.size()) != data_.num_vtxs)
+        FAILURE("SknWriter: optimizeVertexCache() needs the data filled by dumpData()");
+
+    // without materials the whole mesh is a single range
+    std::vector<SknMaterial> ranges = data_.materials;
+    if (ranges.empty())
+    {
+        SknMaterial whole;
+        whole.startVertex = 0;
+        whole.num_vertices = data_.num_vtxs;
+        whole.startIndex = 0;
+        whole.num_indices = data_.num_indices;
+        ranges.push_back(whole);
+    }
+
+    // the vertices are moved inside their range, so startVertex and
+    // startIndex don't change.
+    // a range that doesn't match the mesh (e.g. bad triangles were removed
+    // from a file after its materials were written) is left as it is.
+    const SknVertexStreams old_vertices = data_.vertices;
+    int num_triangles = 0;
+    int num_vertices = 0;
+    int misses_before = 0;
+    int misses_after = 0;
+    int num_ranges = static_cast<int>(ranges.size());
+    for (int i = 0; i < num_ranges; i++)
+    {
+        const SknMaterial& range = ranges[i];
+        if (range.num_indices <= 0)
+            continue;
+
+        bool in_mesh = range.startIndex >= 0 && range.num_indices % 3 == 0 &&
+                       range.startIndex + range.num_indices <= data_.num_indices &&
+                       range.startVertex >= 0 && range.num_vertices >= 0 &&
+                       range.startVertex + range.num_vertices <= data_.num_vtxs;
+        USHORT* indices = in_mesh ? &data_.indices[range.startIndex] : 0;
+        for (int j = 0; in_mesh && j < range.num_indices; j++)
+        {
+            if (indices[j] < range.startVertex || indices[j] >= range.startVertex + range.num_vertices)
+                in_mesh = false;
+        }
+        if (!in_mesh)
+        {
+            MGlobal::displayWarning(MString("SknWriter: material ") + i + " doesn't match the mesh, not reordered");
+            continue;
+        }
+
+        misses_before += countCacheMisses(indices, range.num_indices, range.startVertex, range.num_vertices);
+        optimizeTriangleOrder(indices, range.num_indices, range.startVertex, range.num_vertices);
+        std::vector<int> new_by_old(range.num_vertices);
+        optimizeVertexOrder(indices, range.num_indices, range.startVertex, range.num_vertices, &new_by_old[0]);
+        misses_after += countCacheMisses(indices, range.num_indices, range.startVertex, range.num_vertices);
+        num_triangles += range.num_indices / 3;
+        num_vertices += range.num_vertices;
+
+        for (int j = 0; j < range.num_vertices; j++)
+            data_.vertices.setVtx(range.startVertex + new_by_old[j], old_vertices.getVtx(range.startVertex + j));
+    }
+
+    if (num_triangles && num_vertices)
+    {
+        // 2 decimals is plenty
+        MString report("SknWriter: vertex cache (fifo of ");
+        report += kMeasuredCacheSize;
+        report += MString("), ACMR ") + floor(100.0 * misses_before / num_triangles + 0.5) / 100.0;
+        report += MString(" -> ") + floor(100.0 * misses_after / num_triangles + 0.5) / 100.0;
+        report += MString(", ATVR ") + floor(100.0 * misses_before / num_vertices + 0.5) / 100.0;
+        report += MString(" -> ") + floor(100.0 * misses_after / num_vertices + 0.5) / 100.0;
+        MGlobal::displayInfo(report);
+    }
+
+    return MS::kSuccess;
+}
+
+#ifndef RIOT_HEADLESS
+
 MStatus SknWriter::dumpData(SklData* skl_data)
 {
     MStatus status;
@@ -153,22 +305,22 @@ MStatus SknWriter::dumpData(SklData* skl_data)
     }
     
     // get skl indices by influence index
+    MTimer bind_timer;
+    bind_timer.beginTimer();
+    BoneIndexMap bone_indices(skl_data->joints);
     MIntArray skl_indices_by_influence_index(num_influences);
     for (int i = 0; i < num_influences; i++)
     {
-        MDagPath jointPath = influences_dag_path[i];
-        int j = 0;
-        for (; j < skl_data->num_bones; j++)
-        {
-            if (jointPath == skl_data->joints[j])
-                break;
-        }
-        if (j == skl_data->num_bones)
+        int j = bone_indices.find(influences_dag_path[i]);
+        if (j < 0 || j >= skl_data->num_bones)
             FAILURE("SknWriter: unable to find a bound bone in the skeleton data_.\
                         this error should not happen!");
         
         skl_indices_by_influence_index[i] = j;
     }
+    bind_timer.endTimer();
+    MGlobal::displayInfo(MString("SknWriter: ") + num_influences + " influences found in " +
+                         skl_data->num_bones + " bones in " + bind_timer.elapsedTime() * 1000.0 + " ms");
 
     // will be used for vtx indices
     MIntArray mask_influence_index(num_influences);
@@ -242,53 +394,48 @@ MStatus SknWriter::dumpData(SklData* skl_data)
         }
     }
 
-    // get weights
+    // get weights, all the vertices in one call
     MFnSingleIndexedComponent fn_comp;
     MObject vtx_comp = fn_comp.create(MFn::kMeshVertComponent);
-    MIntArray group_vtx_indices(num_vertices);
-    for (int i = 0; i < num_vertices; i++)
-        group_vtx_indices[i] = i; //TODO:FIX
-    fn_comp.addElements(group_vtx_indices);
+    fn_comp.setCompleteData(num_vertices);
     MDoubleArray weights;
-    int influence_count;
     unsigned int influence_count_tmp;
-    fn_skin_cluster.getWeights(mesh_dag_path, vtx_comp, weights, influence_count_tmp);
-    influence_count = static_cast<int>(influence_count_tmp);
-
-    // check weights (if more than 5 ... "finish him !")
-    for (int i = 0; i < num_vertices; i++)
+    if (MStatus::kSuccess != fn_skin_cluster.getWeights(mesh_dag_path, vtx_comp, weights, influence_count_tmp))
+        FAILURE("SknWriter: MFnSkinCluster::getWeights()");
+    int influence_count = static_cast<int>(influence_count_tmp);
+    if (influence_count != num_influences ||
+        static_cast<int>(weights.length()) != num_vertices * influence_count)
+        FAILURE("SknWriter: the skinCluster weights don't match the mesh");
+
+    // keep the 4 biggest weights of each vertex (if more than 5 ... "prune them !")
+    std::vector<double> weight_matrix(weights.length());
+    if (!weight_matrix.empty())
+        weights.get(&weight_matrix[0]);
+    std::vector<int> vertex_influences(kMaxVertexInfluences * num_vertices);
+    std::vector<float> vertex_weights(kMaxVertexInfluences * num_vertices);
+    InfluenceReport influence_report;
+    if (num_vertices)
+        selectInfluences(weight_matrix.empty() ? 0 : &weight_matrix[0], num_vertices, influence_count,
+                         &vertex_influences[0], &vertex_weights[0], influence_report);
+    if (influence_report.num_pruned)
     {
-        int num = 0;
-        double sum = 0;
-        for (int j = 0; j < influence_count; j++)
-        {
-            double weight = weights[i * influence_count + j];
-            if (weight != 0)
-            {
-                num++;
-                sum += weight;
-            }
-        }
-
-        if (num > 4)
-            FAILURE("SknWriter: plz set max influences to 4 ...");
-
-        // normalize
-        for (int j = 0; j < influence_count; j++)
-        {
-            weights[i * influence_count + j] /= sum;
-        }
+        MGlobal::displayWarning(MString("SknWriter: ") + influence_report.num_pruned +
+            " vertices had more than 4 influences (up to " + influence_report.max_influences +
+            "), the smallest were pruned, at most " +
+            floor(1000.0 * influence_report.max_pruned_weight + 0.5) / 10.0 + "% of a vertex weight");
     }
+    if (influence_report.num_unweighted)
+        MGlobal::displayWarning(MString("SknWriter: ") + influence_report.num_unweighted + " vertices have no weight");
 
     // create stuff for materials :)
     std::vector<MIntArray> shader_vertex_indices; // maya index per data index
                                                 // the size is numFinalVertices
-    std::vector<std::vector<SknVtx>> shader_vtxs;
+    std::vector<std::vector<SknExportVtx>> shader_vtxs;
     std::vector<MIntArray> shader_triangles;
     for (int i = 0; i < shader_count; i++)
     {
         shader_vertex_indices.push_back(MIntArray());
-        std::vector<SknVtx> vtxs;
+        std::vector<SknExportVtx> vtxs;
         shader_vtxs.push_back(vtxs);
         shader_triangles.push_back(MIntArray());
         data_.materials.push_back(SknMaterial());
@@ -309,7 +456,8 @@ MStatus SknWriter::dumpData(SklData* skl_data)
         }
 
         // create and store vtxs for each UVs of the current vertex
-        SknVtx vtx;
+        SknExportVtx vtx;
+        vtx.maya_index = index;
         MPoint pos = mesh_vertices_iter.position(MSpace::kWorld);
         vtx.x = static_cast<float>(pos.x);
         vtx.y = static_cast<float>(pos.y);
@@ -329,17 +477,14 @@ MStatus SknWriter::dumpData(SklData* skl_data)
         vtx.normal[1] = static_cast<float>(normal[1] / numNormals);
         vtx.normal[2] = static_cast<float>(normal[2] / numNormals);
 
-        // search for influences
-        int found = 0;
-        for (int j = 0; j < influence_count && found < 4; j++)
+        // influences
+        for (int j = 0; j < kMaxVertexInfluences; j++)
         {
-            double weight = weights[index * influence_count + j];
-            if (weight != 0)
-            {
-                vtx.skn_indices[found] = static_cast<char>(mask_influence_index[j]);
-                vtx.weights[found] = static_cast<float>(weight);
-                found++;
-            }
+            int influence = vertex_influences[kMaxVertexInfluences * index + j];
+            if (influence < 0)
+                break;
+            vtx.skn_indices[j] = static_cast<char>(mask_influence_index[influence]);
+            vtx.weights[j] = vertex_weights[kMaxVertexInfluences * index + j];
         }
 
         // get unique UVs
@@ -373,32 +518,32 @@ MStatus SknWriter::dumpData(SklData* skl_data)
     // create the id converter from maya index to data index
     // since for each vtx its duplicates are next to it
     // we are gonna choose the index of the first vtx.
-    // Then we fill the data_.vertices .
+    // the duplicates are also indexed by uv, so a face vertex finds its own
+    // with one lookup instead of a scan.
+    // Then we fill export_vtxs (copied to data_.vertices at the end).
+    std::vector<SknExportVtx> export_vtxs;
     int curID = 0;
     MIntArray data_indices(num_vertices, -1);
+    int num_uvs = mesh.numUVs();
+    std::vector<int> data_index_by_uv(num_uvs, -1);
     for (int i = 0; i < shader_count; i++)
     {
         const MIntArray& vertex_indices = shader_vertex_indices.at(i);
-        std::vector<riot::SknVtx>& vtxs = shader_vtxs.at(i);
+        const std::vector<SknExportVtx>& vtxs = shader_vtxs.at(i);
         int vertex_indices_length = static_cast<int>(vertex_indices.length());
         for (int j = 0; j < vertex_indices_length; j++)
         {
             int index = vertex_indices[j];
             if (data_indices[index] == -1) // throw duplicates
-            {
                 data_indices[index] = curID;
-                vtxs.at(j).dupe_data_index = curID;
-            }
-            else
-            {
-                vtxs.at(j).dupe_data_index = data_indices[index];
-            }
+            int uv_index = vtxs.at(j).uv_index;
+            if (uv_index >= 0 && uv_index < num_uvs)
+                data_index_by_uv[uv_index] = curID;
             curID++;
-            //MGlobal::displayInfo(MString("plopi : ") + shader_vtxs.at(i).at(j).dupe_data_index);
         }
 
-        data_.vertices.insert(
-            data_.vertices.end(),
+        export_vtxs.insert(
+            export_vtxs.end(),
             shader_vtxs.at(i).begin(),
             shader_vtxs.at(i).end()
         ); // insert at the end
@@ -421,7 +566,7 @@ MStatus SknWriter::dumpData(SklData* skl_data)
 
             MIntArray new_indices(indices.length(), -1);
             // convert indices using UV indices
-            int data_vertices_size = static_cast<int>(data_.vertices.size());
+            int data_vertices_size = static_cast<int>(export_vtxs.size());
             int indices_length = static_cast<int>(indices.length());
             int vertices_length = static_cast<int>(vertices.length());
             for (int i = 0; i < vertices_length; i++)
@@ -435,22 +580,24 @@ MStatus SknWriter::dumpData(SklData* skl_data)
                 if (data_index >= data_vertices_size)
                     FAILURE(MString("SknWriter: that error should not happen, please report to thispawn. ") + data_index);
 
-                for (int j = data_index; j < data_vertices_size; j++)
+                int j = (uv_index >= 0 && uv_index < num_uvs) ? data_index_by_uv[uv_index] : -1;
+                if (j == -1 || export_vtxs[j].maya_index != vertices[i])
                 {
-                    if (data_.vertices.at(j).dupe_data_index != data_index)
+                    // the uv is shared with another vertex, search the duplicates
+                    j = data_index;
+                    while (j < data_vertices_size && export_vtxs[j].maya_index == vertices[i]
+                           && export_vtxs[j].uv_index != uv_index)
+                        j++;
+                    if (j == data_vertices_size || export_vtxs[j].maya_index != vertices[i])
                     {
                         FAILURE("SknWriter: can't find the corresponding faceVertex in the data, \n" \
                                               "this error should not happen, contact ThiSpawn about this. \n");
                     }
-
-                    if (data_.vertices.at(j).uv_index == uv_index)
-                    {
-                        for (int k = 0; k < indices_length; k++)
-                            if (indices[k] == vertices[i])
-                                new_indices[k] = j;
-                        break;
-                    }
                 }
+
+                for (int k = 0; k < indices_length; k++)
+                    if (indices[k] == vertices[i])
+                        new_indices[k] = j;
             }
 
             int new_indices_length = static_cast<int>(new_indices.length());
@@ -508,8 +655,16 @@ MStatus SknWriter::dumpData(SklData* skl_data)
     data_.num_indices = indiceOffset;
     data_.num_vtxs = vertexOffset;
 
+    // keep only the file fields, as streams
+    int export_vtxs_size = static_cast<int>(export_vtxs.size());
+    data_.vertices.resize(export_vtxs_size);
+    for (int i = 0; i < export_vtxs_size; i++)
+        data_.vertices.setVtx(i, export_vtxs[i]);
+
     return MS::kSuccess;
 }
 
+#endif // RIOT_HEADLESS
+
 } // namespace riot
 
@@ -29,15 +29,30 @@
 
 #include <SklData.hpp>
 #include <SknData.hpp>
+#include <Handedness.hpp>
 
 namespace riot {
 
 class SknWriter
 {
 public:
-    MStatus write(ostream& file);
+    // Hand is SwitchHand or KeepHand, see Handedness.hpp
+    // data_ is left untouched, so it can be written more than once
+    template <class Hand> MStatus write(ostream& file);
+    MStatus write(ostream& file) { return write<SwitchHand>(file); }
+
+    // in memory export : serializedSize() is what write() produces,
+    // buffer must hold at least that
+    int serializedSize() const;
+    template <class Hand> MStatus write(char* buffer, int buffer_size);
+    MStatus write(char* buffer, int buffer_size) { return write<SwitchHand>(buffer, buffer_size); }
     MStatus dumpData(SklData* skl_data);
 
+    // optional, between dumpData and write.
+    // reorders the triangles then the vertices of each material for the
+    // post transform cache, and reports the ACMR / ATVR before and after.
+    MStatus optimizeVertexCache();
+
     SknData data_;
 };
 
@@ -0,0 +1,308 @@
+/*
+    Copyright 2011 Even Entem (alias ThiSpawn).
+
+    This file is part of Riot File Translator Plug-in for AutoDesk Maya.
+
+    Autodesk Maya's lib is under :
+    Copyright 1995, 2006, 2008 Autodesk, Inc. All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful, 
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <TriangleFilter.h>
+
+#include <string.h>
+
+#if defined(__AVX2__)
+#define RIOT_TRIANGLE_FILTER_AVX2
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RIOT_TRIANGLE_FILTER_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace riot {
+
+namespace {
+
+template <class T>
+inline bool isBadTriangle(const T* t, int num_vtxs)
+{
+    int a = t[0];
+    int b = t[1];
+    int c = t[2];
+    return a == b || a == c || b == c ||
+           a < 0 || a >= num_vtxs ||
+           b < 0 || b >= num_vtxs ||
+           c < 0 || c >= num_vtxs;
+}
+
+// filters the triangles [begin, end[, out is advanced past what was written.
+// with out == 0 the triangles are only counted.
+template <class T>
+int filterScalar(const T* in, int begin, int end, int num_vtxs, T*& out, unsigned char* kept)
+{
+    int removed = 0;
+    for (int i = begin; i < end; i++)
+    {
+        const T* t = in + 3 * i;
+        if (isBadTriangle(t, num_vtxs))
+        {
+            removed++;
+            if (kept)
+                kept[i] = 0;
+            continue;
+        }
+
+        if (out)
+        {
+            T a = t[0];
+            T b = t[1];
+            T c = t[2];
+            out[0] = a;
+            out[1] = b;
+            out[2] = c;
+            out += 3;
+        }
+        if (kept)
+            kept[i] = 1;
+    }
+    return removed;
+}
+
+#if defined(RIOT_TRIANGLE_FILTER_AVX2)
+
+typedef __m256i Vec;
+
+inline Vec loadVec(const void* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+inline void storeVec(void* p, Vec v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+inline Vec orVec(Vec a, Vec b) { return _mm256_or_si256(a, b); }
+inline Vec andVec(Vec a, Vec b) { return _mm256_and_si256(a, b); }
+inline Vec zeroVec() { return _mm256_setzero_si256(); }
+inline bool anyVec(Vec v) { return _mm256_movemask_epi8(v) != 0; }
+inline Vec cmpEq(Vec a, Vec b, int) { return _mm256_cmpeq_epi32(a, b); }
+inline Vec cmpEq(Vec a, Vec b, unsigned short) { return _mm256_cmpeq_epi16(a, b); }
+
+#elif defined(RIOT_TRIANGLE_FILTER_SSE2)
+
+typedef __m128i Vec;
+
+inline Vec loadVec(const void* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+inline void storeVec(void* p, Vec v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+inline Vec orVec(Vec a, Vec b) { return _mm_or_si128(a, b); }
+inline Vec andVec(Vec a, Vec b) { return _mm_and_si128(a, b); }
+inline Vec zeroVec() { return _mm_setzero_si128(); }
+inline bool anyVec(Vec v) { return _mm_movemask_epi8(v) != 0; }
+inline Vec cmpEq(Vec a, Vec b, int) { return _mm_cmpeq_epi32(a, b); }
+inline Vec cmpEq(Vec a, Vec b, unsigned short) { return _mm_cmpeq_epi16(a, b); }
+
+#endif
+
+#if defined(RIOT_TRIANGLE_FILTER_AVX2) || defined(RIOT_TRIANGLE_FILTER_SSE2)
+
+// lanes holding an index >= num_vtxs (or < 0)
+template <class T>
+struct RangeCheck;
+
+template <>
+struct RangeCheck<int>
+{
+    explicit RangeCheck(int num_vtxs)
+    {
+        // unsigned compare done as a signed one with the sign bit flipped
+        int bias[sizeof(Vec) / sizeof(int)];
+        int limit[sizeof(Vec) / sizeof(int)];
+        for (int i = 0; i < static_cast<int>(sizeof(Vec) / sizeof(int)); i++)
+        {
+            bias[i] = static_cast<int>(0x80000000u);
+            limit[i] = static_cast<int>(static_cast<unsigned int>(num_vtxs - 1) ^ 0x80000000u);
+        }
+        bias_ = loadVec(bias);
+        limit_ = loadVec(limit);
+    }
+
+    Vec outOfRange(Vec x) const
+    {
+#if defined(RIOT_TRIANGLE_FILTER_AVX2)
+        return _mm256_cmpgt_epi32(_mm256_xor_si256(x, bias_), limit_);
+#else
+        return _mm_cmpgt_epi32(_mm_xor_si128(x, bias_), limit_);
+#endif
+    }
+
+    Vec bias_;
+    Vec limit_;
+};
+
+template <>
+struct RangeCheck<unsigned short>
+{
+    explicit RangeCheck(int num_vtxs)
+    {
+        // x >= num_vtxs <=> x saturated minus (num_vtxs - 1) isn't 0
+        unsigned short limit[sizeof(Vec) / sizeof(unsigned short)];
+        unsigned short last = num_vtxs > 0xFFFF ? 0xFFFF : static_cast<unsigned short>(num_vtxs - 1);
+        for (int i = 0; i < static_cast<int>(sizeof(Vec) / sizeof(unsigned short)); i++)
+            limit[i] = last;
+        limit_ = loadVec(limit);
+    }
+
+    Vec outOfRange(Vec x) const
+    {
+#if defined(RIOT_TRIANGLE_FILTER_AVX2)
+        Vec in_range = _mm256_cmpeq_epi16(_mm256_subs_epu16(x, limit_), _mm256_setzero_si256());
+        return _mm256_xor_si256(in_range, _mm256_cmpeq_epi16(in_range, in_range));
+#else
+        Vec in_range = _mm_cmpeq_epi16(_mm_subs_epu16(x, limit_), _mm_setzero_si128());
+        return _mm_xor_si128(in_range, _mm_cmpeq_epi16(in_range, in_range));
+#endif
+    }
+
+    Vec limit_;
+};
+
+// checks a block of kLanes triangles (3 vectors) at once.
+// each lane is compared to the next one and to the one after,
+// the masks keep the comparisons that stay inside a triangle (a == b, b == c, a == c).
+// the shifted loads read 2 indices past the block.
+template <class T>
+class BlockFilter
+{
+public:
+    static const int kLanes = sizeof(Vec) / sizeof(T);
+
+    explicit BlockFilter(int num_vtxs)
+        : range_(num_vtxs)
+    {
+        T next_mask[3 * kLanes];
+        T after_next_mask[3 * kLanes];
+        for (int i = 0; i < 3 * kLanes; i++)
+        {
+            next_mask[i] = (i % 3 != 2) ? static_cast<T>(~0) : 0;
+            after_next_mask[i] = (i % 3 == 0) ? static_cast<T>(~0) : 0;
+        }
+        for (int v = 0; v < 3; v++)
+        {
+            next_mask_[v] = loadVec(next_mask + v * kLanes);
+            after_next_mask_[v] = loadVec(after_next_mask + v * kLanes);
+        }
+    }
+
+    bool isGood(const T* p) const
+    {
+        Vec bad = zeroVec();
+        for (int v = 0; v < 3; v++)
+        {
+            const T* pv = p + v * kLanes;
+            Vec x = loadVec(pv);
+            Vec next = loadVec(pv + 1);
+            Vec after_next = loadVec(pv + 2);
+            bad = orVec(bad, range_.outOfRange(x));
+            bad = orVec(bad, andVec(cmpEq(x, next, T()), next_mask_[v]));
+            bad = orVec(bad, andVec(cmpEq(x, after_next, T()), after_next_mask_[v]));
+        }
+        return !anyVec(bad);
+    }
+
+    void copy(const T* p, T* out) const
+    {
+        Vec a = loadVec(p);
+        Vec b = loadVec(p + kLanes);
+        Vec c = loadVec(p + 2 * kLanes);
+        storeVec(out, a);
+        storeVec(out + kLanes, b);
+        storeVec(out + 2 * kLanes, c);
+    }
+
+private:
+    RangeCheck<T> range_;
+    Vec next_mask_[3];
+    Vec after_next_mask_[3];
+};
+
+#define RIOT_TRIANGLE_FILTER_SIMD
+
+#endif
+
+template <class T>
+int filter(const T* in, int num_triangles, int num_vtxs, T* out, unsigned char* kept)
+{
+    if (num_triangles <= 0)
+        return 0;
+
+    if (num_vtxs <= 0)
+    {
+        if (kept)
+            memset(kept, 0, num_triangles);
+        return num_triangles;
+    }
+
+    int removed = 0;
+    int i = 0;
+
+#if defined(RIOT_TRIANGLE_FILTER_SIMD)
+    // blocks with a bad triangle are rare, they are done the scalar way.
+    // at least one triangle is left for the end since blocks read past themselves.
+    BlockFilter<T> block(num_vtxs);
+    const int lanes = BlockFilter<T>::kLanes;
+    for (; i + lanes < num_triangles; i += lanes)
+    {
+        const T* p = in + 3 * i;
+        if (block.isGood(p))
+        {
+            if (out)
+            {
+                block.copy(p, out);
+                out += 3 * lanes;
+            }
+            if (kept)
+                memset(kept + i, 1, lanes);
+        }
+        else
+        {
+            removed += filterScalar(in, i, i + lanes, num_vtxs, out, kept);
+        }
+    }
+#endif
+
+    removed += filterScalar(in, i, num_triangles, num_vtxs, out, kept);
+
+    return removed;
+}
+
+} // namespace
+
+int countBadTriangles(const unsigned short* indices, int num_triangles, int num_vtxs)
+{
+    return filter<unsigned short>(indices, num_triangles, num_vtxs, 0, 0);
+}
+
+int countBadTriangles(const int* indices, int num_triangles, int num_vtxs)
+{
+    return filter<int>(indices, num_triangles, num_vtxs, 0, 0);
+}
+
+int filterTriangles(const unsigned short* in, int num_triangles, int num_vtxs,
+                    unsigned short* out, unsigned char* kept)
+{
+    return filter<unsigned short>(in, num_triangles, num_vtxs, out, kept);
+}
+
+int filterTriangles(const int* in, int num_triangles, int num_vtxs,
+                    int* out, unsigned char* kept)
+{
+    return filter<int>(in, num_triangles, num_vtxs, out, kept);
+}
+
+} // namespace riot
@@ -0,0 +1,45 @@
+/*
+    Copyright 2011 Even Entem (alias ThiSpawn).
+
+    This file is part of Riot File Translator Plug-in for AutoDesk Maya.
+
+    Autodesk Maya's lib is under :
+    Copyright 1995, 2006, 2008 Autodesk, Inc. All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful, 
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef RIOT__TRIANGLEFILTER_H
+#define RIOT__TRIANGLEFILTER_H
+
+namespace riot {
+
+// a triangle can't be built if two of its indices are the same
+// or if one of them is out of [0, num_vtxs[.
+
+// returns the number of triangles that can't be built.
+int countBadTriangles(const unsigned short* indices, int num_triangles, int num_vtxs);
+int countBadTriangles(const int* indices, int num_triangles, int num_vtxs);
+
+// copies the triangles that can be built from in to out (out may be in)
+// and returns the number of removed ones.
+// if kept isn't null, kept[i] is set to 1 if the triangle i is kept, 0 else,
+// so the caller can drop the per face data too.
+int filterTriangles(const unsigned short* in, int num_triangles, int num_vtxs,
+                    unsigned short* out, unsigned char* kept = 0);
+int filterTriangles(const int* in, int num_triangles, int num_vtxs,
+                    int* out, unsigned char* kept = 0);
+
+} // namespace riot
+
+#endif
@@ -0,0 +1,257 @@
+/*
+    Copyright 2011 Even Entem (alias ThiSpawn).
+
+    This file is part of Riot File Translator Plug-in for AutoDesk Maya.
+
+    Autodesk Maya's lib is under :
+    Copyright 1995, 2006, 2008 Autodesk, Inc. All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful, 
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <VertexCache.h>
+
+#include <cmath>
+#include <vector>
+
+namespace riot {
+
+namespace {
+
+const int kCacheSize = 32; // lru, for the scores
+const int kMaxValence = 32; // higher valences all get the lowest boost
+
+const float kCacheDecayPower = 1.5f;
+const float kLastTriangleScore = 0.75f;
+const float kValenceBoostScale = 2.0f;
+const float kValenceBoostPower = 0.5f;
+
+struct ScoreTables
+{
+    ScoreTables()
+    {
+        for (int i = 0; i < kCacheSize; i++)
+        {
+            if (i < 3)
+            {
+                // the triangle which was just drawn, whatever its order
+                cache[i] = kLastTriangleScore;
+            }
+            else
+            {
+                float scaler = 1.0f / (kCacheSize - 3);
+                cache[i] = powf(1.0f - (i - 3) * scaler, kCacheDecayPower);
+            }
+        }
+        valence[0] = 0.0f;
+        for (int i = 1; i <= kMaxValence; i++)
+            valence[i] = kValenceBoostScale * powf(static_cast<float>(i), -kValenceBoostPower);
+    }
+
+    float cache[kCacheSize];
+    float valence[kMaxValence + 1];
+};
+
+const ScoreTables& scoreTables()
+{
+    static ScoreTables tables;
+    return tables;
+}
+
+// remaining_triangles == 0 means the vertex won't be needed anymore
+float vertexScore(int cache_position, int remaining_triangles)
+{
+    if (!remaining_triangles)
+        return -1.0f;
+
+    const ScoreTables& tables = scoreTables();
+    float score = cache_position < 0 ? 0.0f : tables.cache[cache_position];
+    if (remaining_triangles > kMaxValence)
+        remaining_triangles = kMaxValence;
+    return score + tables.valence[remaining_triangles];
+}
+
+} // namespace
+
+int countCacheMisses(const unsigned short* indices, int num_indices,
+                     int first_vertex, int num_vertices, int cache_size)
+{
+    // time stamp of the vertex's last entry in the fifo
+    std::vector<int> entered(num_vertices, -cache_size - 1);
+    int misses = 0;
+    for (int i = 0; i < num_indices; i++)
+    {
+        int vertex = indices[i] - first_vertex;
+        if (misses - entered[vertex] > cache_size)
+        {
+            entered[vertex] = misses;
+            misses++;
+        }
+    }
+    return misses;
+}
+
+void optimizeTriangleOrder(unsigned short* indices, int num_indices,
+                           int first_vertex, int num_vertices)
+{
+    int num_triangles = num_indices / 3;
+    if (num_triangles < 2)
+        return;
+
+    // triangles of each vertex
+    std::vector<int> triangle_offsets(num_vertices + 1, 0);
+    for (int i = 0; i < num_indices; i++)
+        triangle_offsets[indices[i] - first_vertex + 1]++;
+    for (int i = 0; i < num_vertices; i++)
+        triangle_offsets[i + 1] += triangle_offsets[i];
+    std::vector<int> remaining(num_vertices);
+    for (int i = 0; i < num_vertices; i++)
+        remaining[i] = triangle_offsets[i + 1] - triangle_offsets[i];
+    std::vector<int> vertex_triangles(num_indices);
+    {
+        std::vector<int> fill(triangle_offsets.begin(), triangle_offsets.end() - 1);
+        for (int i = 0; i < num_indices; i++)
+            vertex_triangles[fill[indices[i] - first_vertex]++] = i / 3;
+    }
+
+    std::vector<int> cache_position(num_vertices, -1);
+    std::vector<float> vertex_scores(num_vertices);
+    for (int i = 0; i < num_vertices; i++)
+        vertex_scores[i] = vertexScore(-1, remaining[i]);
+
+    std::vector<unsigned char> drawn(num_triangles, 0);
+    int best_triangle = 0;
+    float best_score = -1.0f;
+    for (int i = 0; i < num_triangles; i++)
+    {
+        float score = 0.0f;
+        for (int k = 0; k < 3; k++)
+            score += vertex_scores[indices[i * 3 + k] - first_vertex];
+        if (score > best_score)
+        {
+            best_score = score;
+            best_triangle = i;
+        }
+    }
+
+    std::vector<unsigned short> output(num_indices);
+    int cache[kCacheSize + 3];
+    int cache_used = 0;
+    int next_undrawn = 0; // for when the cache has nothing left to offer
+
+    for (int drawn_count = 0; drawn_count < num_triangles; drawn_count++)
+    {
+        if (best_triangle < 0)
+        {
+            while (drawn[next_undrawn])
+                next_undrawn++;
+            best_triangle = next_undrawn;
+        }
+
+        const unsigned short* triangle = indices + best_triangle * 3;
+        for (int k = 0; k < 3; k++)
+            output[drawn_count * 3 + k] = triangle[k];
+        drawn[best_triangle] = 1;
+
+        // the triangle isn't waiting on its vertices anymore
+        for (int k = 0; k < 3; k++)
+        {
+            int vertex = triangle[k] - first_vertex;
+            int* begin = &vertex_triangles[triangle_offsets[vertex]];
+            int* end = begin + remaining[vertex];
+            for (int* t = begin; t != end; t++)
+            {
+                if (*t == best_triangle)
+                {
+                    *t = *(end - 1);
+                    break;
+                }
+            }
+            remaining[vertex]--;
+        }
+
+        // its vertices go to the front of the cache
+        int new_cache[kCacheSize + 3];
+        int new_cache_used = 0;
+        for (int k = 0; k < 3; k++)
+            new_cache[new_cache_used++] = triangle[k] - first_vertex;
+        for (int i = 0; i < cache_used; i++)
+        {
+            int vertex = cache[i];
+            if (vertex != new_cache[0] && vertex != new_cache[1] && vertex != new_cache[2])
+                new_cache[new_cache_used++] = vertex;
+        }
+
+        // update the scores of what is in the cache, and of what just left it
+        for (int i = 0; i < new_cache_used; i++)
+        {
+            int vertex = new_cache[i];
+            int position = i < kCacheSize ? i : -1;
+            cache_position[vertex] = position;
+            vertex_scores[vertex] = vertexScore(position, remaining[vertex]);
+        }
+
+        // the next triangle is the best one among those touching the cache
+        best_triangle = -1;
+        best_score = -1.0f;
+        for (int i = 0; i < new_cache_used; i++)
+        {
+            int vertex = new_cache[i];
+            const int* begin = &vertex_triangles[triangle_offsets[vertex]];
+            const int* end = begin + remaining[vertex];
+            for (const int* t = begin; t != end; t++)
+            {
+                const unsigned short* candidate = indices + *t * 3;
+                float score = vertex_scores[candidate[0] - first_vertex]
+                            + vertex_scores[candidate[1] - first_vertex]
+                            + vertex_scores[candidate[2] - first_vertex];
+                if (score > best_score)
+                {
+                    best_score = score;
+                    best_triangle = *t;
+                }
+            }
+        }
+
+        cache_used = new_cache_used < kCacheSize ? new_cache_used : kCacheSize;
+        for (int i = 0; i < cache_used; i++)
+            cache[i] = new_cache[i];
+    }
+
+    for (int i = 0; i < num_indices; i++)
+        indices[i] = output[i];
+}
+
+void optimizeVertexOrder(unsigned short* indices, int num_indices,
+                         int first_vertex, int num_vertices, int* new_by_old)
+{
+    for (int i = 0; i < num_vertices; i++)
+        new_by_old[i] = -1;
+
+    int next = 0;
+    for (int i = 0; i < num_indices; i++)
+    {
+        int vertex = indices[i] - first_vertex;
+        if (new_by_old[vertex] == -1)
+            new_by_old[vertex] = next++;
+        indices[i] = static_cast<unsigned short>(first_vertex + new_by_old[vertex]);
+    }
+
+    for (int i = 0; i < num_vertices; i++)
+    {
+        if (new_by_old[i] == -1)
+            new_by_old[i] = next++;
+    }
+}
+
+} // namespace riot
@@ -0,0 +1,592 @@
+/*
+    Copyright 2011 Even Entem (alias ThiSpawn).
+
+    This file is part of Riot File Translator Plug-in for AutoDesk Maya.
+
+    Autodesk Maya's lib is under :
+    Copyright 1995, 2006, 2008 Autodesk, Inc. All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful, 
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <Converter.h>
+
+#include <cmath>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+
+#include <maya/MStatus.h>
+
+#include <Handedness.hpp>
+#include <SknReader.h>
+#include <SknWriter.h>
+#include <SklReader.h>
+#include <SklWriter.h>
+#include <AnmReader.h>
+#include <AnmWriter.h>
+#include <AnmResampler.h>
+#include <AnmKeyReduction.h>
+#include <AnmBounds.h>
+#include <ScbReader.h>
+#include <ScbWriter.h>
+#include <ScoReader.h>
+#include <ScoWriter.h>
+#include <maya_misc.h>
+
+namespace riot {
+
+namespace {
+
+// binary formats must come back bit for bit
+template <class T>
+bool sameBits(const T* a, const T* b, int count)
+{
+    return count <= 0 || !memcmp(a, b, count * sizeof(T));
+}
+
+// sco is text, the writer prints 4 decimals for the points
+bool nearlyEqual(double a, double b)
+{
+    return fabs(a - b) <= 1e-4 + 1e-6 * fabs(a);
+}
+
+std::string mismatch(const char* what, int index = -1)
+{
+    std::ostringstream message;
+    message << what;
+    if (index >= 0)
+        message << " " << index;
+    message << " differs";
+    return message.str();
+}
+
+bool readStream(const std::string& file_name, std::ifstream& file, ios::openmode mode)
+{
+    file.open(file_name.c_str(), mode);
+    return file.is_open();
+}
+
+struct SknFormat
+{
+    typedef SknReader Reader;
+    typedef SknWriter Writer;
+
+    static MStatus readFile(Reader& reader, const std::string& file_name)
+    {
+        return reader.read<KeepHand>(file_name.c_str());
+    }
+
+    static void prepare(const SknData& in, SknData& out)
+    {
+        out = in;
+        // version 0 has no materials, the writer wants one
+        if (out.materials.empty())
+        {
+            SknMaterial material;
+            strcpy_s(material.name, SknMaterial::kNameLen, "lambert1");
+            material.startVertex = 0;
+            material.num_vertices = out.num_vtxs;
+            material.startIndex = 0;
+            material.num_indices = out.num_indices;
+            out.materials.push_back(material);
+        }
+    }
+
+    static std::string compare(const SknData& written, const SknData& read)
+    {
+        if (written.num_vtxs != read.num_vtxs)
+            return mismatch("vertex count");
+        if (written.num_indices != read.num_indices ||
+            !sameBits(written.index_view, read.index_view, written.num_indices))
+            return mismatch("indices");
+        if (written.materials.size() != read.materials.size())
+            return mismatch("material count");
+        for (size_t i = 0; i < written.materials.size(); i++)
+        {
+            if (memcmp(&written.materials[i], &read.materials[i], SknMaterial::kSizeInFile))
+                return mismatch("material", static_cast<int>(i));
+        }
+
+        const SknVertexStreams& a = written.vertices;
+        const SknVertexStreams& b = read.vertices;
+        int n = written.num_vtxs;
+        if (!sameBits(a.positions.data(), b.positions.data(), 4 * n))
+            return mismatch("positions");
+        if (!sameBits(a.normals.data(), b.normals.data(), 3 * n))
+            return mismatch("normals");
+        if (!sameBits(a.u.data(), b.u.data(), n) || !sameBits(a.v.data(), b.v.data(), n))
+            return mismatch("uvs");
+        if (!sameBits(a.skn_indices.data(), b.skn_indices.data(), 4 * n))
+            return mismatch("bone indices");
+        if (!sameBits(a.weights.data(), b.weights.data(), 4 * n))
+            return mismatch("weights");
+        return std::string();
+    }
+};
+
+struct SklFormat
+{
+    typedef SklReader Reader;
+    typedef SklWriter Writer;
+
+    static MStatus readFile(Reader& reader, const std::string& file_name)
+    {
+        std::ifstream file;
+        if (!readStream(file_name, file, ios::binary))
+            return MS::kFailure;
+        return reader.read<KeepHand>(file);
+    }
+
+    static void prepare(const SklData& in, SklData& out)
+    {
+        out = in;
+        if (out.version == 3)
+            out.version = 2;
+    }
+
+    static std::string compare(const SklData& written, const SklData& read)
+    {
+        if (written.num_bones != read.num_bones)
+            return mismatch("bone count");
+        for (int i = 0; i < written.num_bones; i++)
+        {
+            const SklBone& a = written.bones[i];
+            const SklBone& b = read.bones[i];
+            if (strncmp(a.name, b.name, SklBone::kNameLen) || a.parent != b.parent ||
+                !sameBits(&a.scale, &b.scale, 1) || !sameBits(&a.transform[0][0], &b.transform[0][0], 16))
+                return mismatch("bone", i);
+        }
+        if (written.version == 2)
+        {
+            if (written.num_indices != read.num_indices)
+                return mismatch("skn index count");
+            for (int i = 0; i < written.num_indices; i++)
+            {
+                if (written.skn_indices[i] != read.skn_indices[i])
+                    return mismatch("skn index", i);
+            }
+        }
+        return std::string();
+    }
+};
+
+struct AnmFormat
+{
+    typedef AnmReader Reader;
+    typedef AnmWriter Writer;
+
+    static MStatus readFile(Reader& reader, const std::string& file_name)
+    {
+        std::ifstream file;
+        if (!readStream(file_name, file, ios::binary))
+            return MS::kFailure;
+        reader.packed_ = true;
+        return reader.read<KeepHand>(file);
+    }
+
+    static void prepare(const AnmData& in, AnmData& out)
+    {
+        out = in;
+    }
+
+    // fps isn't compared, v3 stores it as an int and v4 as a frame duration.
+    // v4 has no names nor flags, only name hashes.
+    static std::string compare(const AnmData& written, const AnmData& read)
+    {
+        if (written.num_bones != read.num_bones || written.num_frames != read.num_frames)
+            return mismatch("bone or frame count");
+        for (int i = 0; i < written.num_bones; i++)
+        {
+            const AnmBone& a = written.bones[i];
+            const AnmBone& b = read.bones[i];
+            bool same_bone = written.version == 4
+                ? (a.name_hash ? a.name_hash : hashName(a.name)) == b.name_hash
+                : !strncmp(a.name, b.name, AnmBone::kNameLen) && a.flag == b.flag;
+            if (!same_bone)
+                return mismatch("bone", i);
+            for (int j = 0; j < written.num_frames; j++)
+            {
+                AnmPos written_pos, read_pos;
+                written.getPose(i, j, written_pos);
+                read.getPose(i, j, read_pos);
+                if (memcmp(&written_pos, &read_pos, AnmPos::kSizeInFile))
+                    return mismatch("frame", j);
+            }
+        }
+        return std::string();
+    }
+};
+
+struct ScbFormat
+{
+    typedef ScbReader Reader;
+    typedef ScbWriter Writer;
+
+    static MStatus readFile(Reader& reader, const std::string& file_name)
+    {
+        std::ifstream file;
+        if (!readStream(file_name, file, ios::binary))
+            return MS::kFailure;
+        return reader.read<KeepHand>(file);
+    }
+
+    static void prepare(const ScbData& in, ScbData& out)
+    {
+        out = in;
+        if (out.version == 0x20002)
+            return;
+
+        // older versions have no box, the writer always puts one
+        // computed as ScbWriter::dumpData does : min and size
+        int num_vertices = static_cast<int>(out.vertices.size());
+        out.bbx = out.bby = out.bbz = 0.0f;
+        out.bbdx = out.bbdy = out.bbdz = 0.0f;
+        for (int i = 0; i < num_vertices; i++)
+        {
+            const ScbVtx& vtx = out.vertices[i];
+            if (vtx.x < out.bbx || i == 0)
+                out.bbx = vtx.x;
+            if (vtx.y < out.bby || i == 0)
+                out.bby = vtx.y;
+            if (vtx.z < out.bbz || i == 0)
+                out.bbz = vtx.z;
+            if (vtx.x > out.bbdx || i == 0)
+                out.bbdx = vtx.x;
+            if (vtx.y > out.bbdy || i == 0)
+                out.bbdy = vtx.y;
+            if (vtx.z > out.bbdz || i == 0)
+                out.bbdz = vtx.z;
+        }
+        out.bbdx -= out.bbx;
+        out.bbdy -= out.bby;
+        out.bbdz -= out.bbz;
+    }
+
+    static std::string compare(const ScbData& written, const ScbData& read)
+    {
+        if (written.num_vtxs != read.num_vtxs ||
+            !sameBits(written.vertices.data(), read.vertices.data(), written.num_vtxs))
+            return mismatch("vertices");
+        float written_bb[6] = {written.bbx, written.bby, written.bbz, written.bbdx, written.bbdy, written.bbdz};
+        float read_bb[6] = {read.bbx, read.bby, read.bbz, read.bbdx, read.bbdy, read.bbdz};
+        if (!sameBits(written_bb, read_bb, 6))
+            return mismatch("bounding box");
+        if (written.num_indices != read.num_indices || written.indices != read.indices)
+            return mismatch("indices");
+        if (written.shader_per_triangle != read.shader_per_triangle ||
+            written.materials.size() != read.materials.size())
+            return mismatch("materials");
+        for (size_t i = 0; i < written.materials.size(); i++)
+        {
+            if (strncmp(written.materials[i].name, read.materials[i].name, ScbMaterial::kNameLen))
+                return mismatch("material", static_cast<int>(i));
+        }
+        if (written.u_vec != read.u_vec || written.v_vec != read.v_vec)
+            return mismatch("uvs");
+        return std::string();
+    }
+};
+
+struct ScoFormat
+{
+    typedef ScoReader Reader;
+    typedef ScoWriter Writer;
+
+    static MStatus readFile(Reader& reader, const std::string& file_name)
+    {
+        std::ifstream file;
+        if (!readStream(file_name, file, ios::in)) // not binary
+            return MS::kFailure;
+        return reader.read<KeepHand>(file);
+    }
+
+    static void prepare(const ScoData& in, ScoData& out)
+    {
+        out = in;
+    }
+
+    static std::string compare(const ScoData& written, const ScoData& read)
+    {
+        if (!(written.name == read.name))
+            return mismatch("name");
+        if (!nearlyEqual(written.tx, read.tx) || !nearlyEqual(written.ty, read.ty) ||
+            !nearlyEqual(written.tz, read.tz))
+            return mismatch("central point");
+        if (written.use_pivot != read.use_pivot ||
+            (written.use_pivot && (!nearlyEqual(written.px, read.px) ||
+                                   !nearlyEqual(written.py, read.py) ||
+                                   !nearlyEqual(written.pz, read.pz))))
+            return mismatch("pivot point");
+        if (written.num_vtxs != read.num_vtxs)
+            return mismatch("vertex count");
+        for (int i = 0; i < written.num_vtxs; i++)
+        {
+            const ScoVtx& a = written.vertices[i];
+            const ScoVtx& b = read.vertices[i];
+            if (!nearlyEqual(a.x, b.x) || !nearlyEqual(a.y, b.y) || !nearlyEqual(a.z, b.z))
+                return mismatch("vertex", i);
+        }
+        if (written.num_indices != read.num_indices || written.indices != read.indices)
+            return mismatch("indices");
+        if (written.shader_per_triangle != read.shader_per_triangle ||
+            written.materials.size() != read.materials.size())
+            return mismatch("materials");
+        for (size_t i = 0; i < written.u_vec.size(); i++)
+        {
+            if (!nearlyEqual(written.u_vec[i], read.u_vec[i]) ||
+                !nearlyEqual(written.v_vec[i], read.v_vec[i]))
+                return mismatch("uv", static_cast<int>(i));
+        }
+        return std::string();
+    }
+};
+
+// only the anm writer knows two versions
+inline void setVersion(AnmWriter& writer, int version)
+{
+    if (version)
+        writer.data_.version = version;
+}
+
+template <class Writer>
+void setVersion(Writer& /*writer*/, int /*version*/)
+{
+}
+
+// only the anm writer can be retimed. the files are already spread
+// between the threads, so the resampler runs on this one.
+// with -v its rate is shown, in bone-frames written per second.
+inline MStatus retime(AnmWriter& writer, float fps)
+{
+    AnmData retimed;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    if (resampleAnimationToFps(writer.data_, fps, kInterpolateSlerp, retimed, false) != MS::kSuccess)
+        return MS::kFailure;
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    double bone_frames = static_cast<double>(retimed.num_bones) * retimed.num_frames;
+    double seconds = elapsed.count();
+    MGlobal::displayInfo(MString("AnmResampler: ") + writer.data_.num_frames + " to " + retimed.num_frames +
+                         " frames of " + retimed.num_bones + " bones in " + floor(seconds * 1e6 + 0.5) / 1e3 +
+                         " ms, " + (seconds > 0.0 ? floor(bone_frames / seconds / 1e6 * 100.0 + 0.5) / 100.0 : 0.0) +
+                         " M bone-frames/s");
+    writer.data_ = retimed;
+    return MS::kSuccess;
+}
+
+template <class Writer>
+MStatus retime(Writer& /*writer*/, float /*fps*/)
+{
+    return MS::kSuccess;
+}
+
+// only the anm writer has keys to reduce, on this thread too
+inline MStatus reduce(AnmWriter& writer, float angle, float position)
+{
+    std::vector<AnmTolerance> tolerances(1, AnmTolerance(angle * 3.14159265f / 180.0f, position));
+    std::vector<AnmBoneKeys> keys;
+    AnmReductionReport report;
+    if (reduceKeys(writer.data_, tolerances, keys, report, false) != MS::kSuccess)
+        return MS::kFailure;
+    return applyKeys(keys, writer.data_, false);
+}
+
+template <class Writer>
+MStatus reduce(Writer& /*writer*/, float /*angle*/, float /*position*/)
+{
+    return MS::kSuccess;
+}
+
+// only the anm files have bounds, computed on what was written
+inline MStatus bound(const AnmWriter& writer, const ConvertOptions& options)
+{
+    AnmBounds bounds;
+    if (computeBounds(*options.bounds_skeleton, writer.data_, options.bounds_mesh, bounds, false) != MS::kSuccess)
+        return MS::kFailure;
+    std::string name = options.output_name.substr(0, options.output_name.rfind('.')) + ".bnds";
+    std::ofstream file(name.c_str(), ios::out | ios::binary);
+    return writeBounds(bounds, file);
+}
+
+template <class Writer>
+MStatus bound(const Writer& /*writer*/, const ConvertOptions& /*options*/)
+{
+    return MS::kSuccess;
+}
+
+// only the skn writer has an optional stage
+inline MStatus optimize(SknWriter& writer)
+{
+    return writer.optimizeVertexCache();
+}
+
+template <class Writer>
+MStatus optimize(Writer& /*writer*/)
+{
+    return MS::kSuccess;
+}
+
+template <class Format>
+void convert(const std::string& file_name, const ConvertOptions& options, ConvertResult& result)
+{
+    typename Format::Reader reader;
+    if (Format::readFile(reader, file_name) != MS::kSuccess)
+    {
+        result.error = "read failed";
+        return;
+    }
+
+    if (options.output_name.empty() && !options.round_trip)
+    {
+        result.success = true;
+        return;
+    }
+
+    typename Format::Writer writer;
+    Format::prepare(reader.data_, writer.data_);
+    setVersion(writer, options.anm_version);
+    if (options.anm_fps > 0.0f && retime(writer, options.anm_fps) != MS::kSuccess)
+    {
+        result.error = "resampling failed";
+        return;
+    }
+    if ((options.anm_key_angle > 0.0f || options.anm_key_position > 0.0f) &&
+        reduce(writer, options.anm_key_angle, options.anm_key_position) != MS::kSuccess)
+    {
+        result.error = "keyframe reduction failed";
+        return;
+    }
+    if (options.vertex_cache && optimize(writer) != MS::kSuccess)
+    {
+        result.error = "vertex cache optimization failed";
+        return;
+    }
+
+    std::ostringstream out(ios::out | ios::binary);
+    if (writer.template write<KeepHand>(out) != MS::kSuccess)
+    {
+        result.error = "write failed";
+        return;
+    }
+    const std::string bytes = out.str();
+    result.bytes_out = static_cast<long long>(bytes.size());
+
+    if (!options.output_name.empty())
+    {
+        std::ofstream file(options.output_name.c_str(), ios::out | ios::binary);
+        file.write(bytes.data(), bytes.size());
+        if (!file)
+        {
+            result.error = "could not write " + options.output_name;
+            return;
+        }
+        if (options.bounds_skeleton && bound(writer, options) != MS::kSuccess)
+        {
+            result.error = "bounds failed";
+            return;
+        }
+    }
+
+    if (options.round_trip)
+    {
+        std::istringstream in(bytes, ios::in | ios::binary);
+        typename Format::Reader round_trip_reader;
+        if (round_trip_reader.template read<KeepHand>(in) != MS::kSuccess)
+        {
+            result.error = "round trip: read back failed";
+            return;
+        }
+        std::string difference = Format::compare(writer.data_, round_trip_reader.data_);
+        if (!difference.empty())
+        {
+            result.error = "round trip: " + difference;
+            return;
+        }
+    }
+
+    result.success = true;
+}
+
+} // namespace
+
+bool readSkeleton(const std::string& file_name, SklData& skeleton)
+{
+    SklReader reader;
+    if (SklFormat::readFile(reader, file_name) != MS::kSuccess)
+        return false;
+    skeleton = reader.data_;
+    return true;
+}
+
+bool readMesh(const std::string& file_name, SknData& mesh)
+{
+    SknReader reader;
+    if (SknFormat::readFile(reader, file_name) != MS::kSuccess)
+        return false;
+    SknFormat::prepare(reader.data_, mesh);
+    return true;
+}
+
+FileFormat formatFromName(const std::string& file_name)
+{
+    size_t dot = file_name.rfind('.');
+    if (dot == std::string::npos)
+        return kUnknownFormat;
+
+    const char* extension = file_name.c_str() + dot + 1;
+    if (!_stricmp(extension, "skn"))
+        return kSknFormat;
+    if (!_stricmp(extension, "skl"))
+        return kSklFormat;
+    if (!_stricmp(extension, "anm"))
+        return kAnmFormat;
+    if (!_stricmp(extension, "scb"))
+        return kScbFormat;
+    if (!_stricmp(extension, "sco"))
+        return kScoFormat;
+    return kUnknownFormat;
+}
+
+ConvertResult convertFile(const std::string& file_name, FileFormat format,
+                          const ConvertOptions& options)
+{
+    ConvertResult result;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    {
+        std::ifstream file(file_name.c_str(), ios::binary | ios::ate);
+        if (!file)
+        {
+            result.error = "could not be opened for reading";
+            return result;
+        }
+        result.bytes_in = static_cast<long long>(file.tellg());
+    }
+
+    switch (format)
+    {
+    case kSknFormat: convert<SknFormat>(file_name, options, result); break;
+    case kSklFormat: convert<SklFormat>(file_name, options, result); break;
+    case kAnmFormat: convert<AnmFormat>(file_name, options, result); break;
+    case kScbFormat: convert<ScbFormat>(file_name, options, result); break;
+    case kScoFormat: convert<ScoFormat>(file_name, options, result); break;
+    default: result.error = "unknown format"; break;
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    result.seconds = elapsed.count();
+    return result;
+}
+
+} // namespace riot
@@ -0,0 +1,105 @@
+/*
+    Copyright 2011 Even Entem (alias ThiSpawn).
+
+    This file is part of Riot File Translator Plug-in for AutoDesk Maya.
+
+    Autodesk Maya's lib is under :
+    Copyright 1995, 2006, 2008 Autodesk, Inc. All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful, 
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef RIOT__CONVERTER_H
+#define RIOT__CONVERTER_H
+
+#include <string>
+
+namespace riot {
+
+class SknData;
+struct SklData;
+
+enum FileFormat
+{
+    kUnknownFormat = 0,
+    kSknFormat,
+    kSklFormat,
+    kAnmFormat,
+    kScbFormat,
+    kScoFormat
+};
+
+// from the extension, case insensitive
+FileFormat formatFromName(const std::string& file_name);
+
+struct ConvertOptions
+{
+    ConvertOptions() : round_trip(false), vertex_cache(false), anm_version(0), anm_fps(0.0f), anm_key_angle(0.0f), anm_key_position(0.0f),
+                       bounds_skeleton(0), bounds_mesh(0)
+    {
+    }
+
+    // the file is written back there when it is not empty.
+    // skl of type raw are written as type 2, that's all the writer knows.
+    std::string output_name;
+
+    // serialize in memory, read it back and compare with what was written
+    bool round_trip;
+
+    // skn only, see SknWriter::optimizeVertexCache()
+    bool vertex_cache;
+
+    // 3 or 4 to write the anm files as that version, 0 keeps theirs
+    int anm_version;
+
+    // retime the anm files to that frame rate (slerp), 0 keeps theirs
+    float anm_fps;
+
+    // keyframe reduction of the anm files, in degrees and units, see
+    // reduceKeys(). 0 and 0 keeps every key
+    float anm_key_angle;
+    float anm_key_position;
+
+    // with a skeleton, the per frame bounds of the anm files are written
+    // next to them (.bnds instead of .anm), see computeBounds(). the mesh
+    // is optional, without it only the bones are bounded
+    const SklData* bounds_skeleton;
+    const SknData* bounds_mesh;
+};
+
+struct ConvertResult
+{
+    ConvertResult() : success(false), bytes_in(0), bytes_out(0), seconds(0.0) {}
+
+    bool success;
+    std::string error;
+    long long bytes_in;
+    long long bytes_out; // 0 if nothing was serialized
+    double seconds;
+};
+
+// the skeleton and the mesh of the bounds, read once for every file.
+// the mesh keeps its indices, they don't point in the file anymore.
+bool readSkeleton(const std::string& file_name, SklData& skeleton);
+bool readMesh(const std::string& file_name, SknData& mesh);
+
+// reads a file with the format readers and, depending on the options,
+// writes it back and/or checks the round trip.
+// the data is kept in file coordinates, nothing is switched to maya's.
+// safe to call from several threads at once.
+ConvertResult convertFile(const std::string& file_name, FileFormat format,
+                          const ConvertOptions& options);
+
+} // namespace riot
+
+#endif
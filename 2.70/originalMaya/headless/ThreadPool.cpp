@@ -0,0 +1,130 @@
+/*
+    Copyright 2011 Even Entem (alias ThiSpawn).
+
+    This file is part of Riot File Translator Plug-in for AutoDesk Maya.
+
+    Autodesk Maya's lib is under :
+    Copyright 1995, 2006, 2008 Autodesk, Inc. All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful, 
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <ThreadPool.h>
+
+namespace riot {
+
+ThreadPool::ThreadPool(int num_threads)
+    : next_queue_(0), queued_(0), pending_(0), stop_(false)
+{
+    if (num_threads <= 0)
+        num_threads = static_cast<int>(std::thread::hardware_concurrency());
+    if (num_threads <= 0)
+        num_threads = 1;
+
+    for (int i = 0; i < num_threads; i++)
+        queues_.push_back(std::unique_ptr<Queue>(new Queue()));
+    for (int i = 0; i < num_threads; i++)
+        workers_.push_back(std::thread(&ThreadPool::run, this, i));
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    work_available_.notify_all();
+    for (size_t i = 0; i < workers_.size(); i++)
+        workers_[i].join();
+}
+
+void ThreadPool::push(Task task)
+{
+    // round robin, the stealing evens it out
+    Queue& queue = *queues_[next_queue_++ % queues_.size()];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queued_++;
+        pending_++;
+    }
+    work_available_.notify_one();
+}
+
+void ThreadPool::wait()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (pending_)
+        all_done_.wait(lock);
+}
+
+bool ThreadPool::pop(int index, Task& task)
+{
+    Queue& queue = *queues_[index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty())
+        return false;
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    return true;
+}
+
+bool ThreadPool::steal(int index, Task& task)
+{
+    int num_queues = static_cast<int>(queues_.size());
+    for (int i = 1; i < num_queues; i++)
+    {
+        Queue& queue = *queues_[(index + i) % num_queues];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty())
+            continue;
+        task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+        return true;
+    }
+    return false;
+}
+
+void ThreadPool::run(int index)
+{
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            while (!stop_ && !queued_)
+                work_available_.wait(lock);
+            if (stop_ && !queued_)
+                return;
+        }
+
+        Task task;
+        if (!pop(index, task) && !steal(index, task))
+            continue; // someone else was faster
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            queued_--;
+        }
+
+        task();
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!--pending_)
+            all_done_.notify_all();
+    }
+}
+
+} // namespace riot
@@ -0,0 +1,81 @@
+/*
+    Copyright 2011 Even Entem (alias ThiSpawn).
+
+    This file is part of Riot File Translator Plug-in for AutoDesk Maya.
+
+    Autodesk Maya's lib is under :
+    Copyright 1995, 2006, 2008 Autodesk, Inc. All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful, 
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef RIOT__THREADPOOL_H
+#define RIOT__THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace riot {
+
+// work stealing pool.
+// each worker has its own queue, it takes its tasks from the back and when
+// it runs dry it steals from the front of the others. files vary a lot in
+// size, so this keeps everyone busy until the end of a batch.
+class ThreadPool
+{
+public:
+    typedef std::function<void()> Task;
+
+    explicit ThreadPool(int num_threads = 0); // 0 : one per hardware thread
+    ~ThreadPool();
+
+    int size() const { return static_cast<int>(workers_.size()); }
+
+    void push(Task task);
+    void wait(); // until every pushed task has run
+
+private:
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    ThreadPool(const ThreadPool&);
+    ThreadPool& operator=(const ThreadPool&);
+
+    bool pop(int index, Task& task);
+    bool steal(int index, Task& task);
+    void run(int index);
+
+    std::vector<std::unique_ptr<Queue> > queues_;
+    std::vector<std::thread> workers_;
+    std::atomic<unsigned int> next_queue_;
+
+    std::mutex mutex_;
+    std::condition_variable work_available_;
+    std::condition_variable all_done_;
+    int queued_; // tasks waiting in the queues, guarded by mutex_
+    int pending_; // tasks pushed and not finished yet, guarded by mutex_
+    bool stop_;
+};
+
+} // namespace riot
+
+#endif
@@ -0,0 +1,336 @@
+/*
+    Copyright 2011 Even Entem (alias ThiSpawn).
+
+    This file is part of Riot File Translator Plug-in for AutoDesk Maya.
+
+    Autodesk Maya's lib is under :
+    Copyright 1995, 2006, 2008 Autodesk, Inc. All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful, 
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+// riotconv : converts / validates riot files without maya.
+//
+// riotconv [-o output_dir] [-r] [-c] [-3|-4] [-f fps] [-k degrees,units] [-b skeleton.skl[,mesh.skn]] [-j threads] [-q] [-v] files or directories...
+//   -o  write every file back into output_dir (same tree as the input)
+//   -r  round trip : serialize in memory, read it back and compare
+//   -c  reorder the skn triangles and vertices for the vertex cache
+//       before writing them (with -v the ACMR / ATVR are shown)
+//   -3  write the anm files as version 3 (a pose per bone per frame)
+//   -4  write the anm files as version 4 (pooled keys, with -v the
+//       compression ratio is shown), by default they keep their version
+//   -f  retime the anm files to fps frames per second (slerp, with -v
+//       the bone-frames resampled per second are shown), the
+//       interpolated keys rarely fit the version 4 pools, add -3 then
+//   -k  drop the anm keys that slerp / lerp rebuild within degrees and
+//       units, the static bones then take a single version 4 key
+//   -b  with -o, write the per frame bounds of every bone of skeleton.skl
+//       (and of every material of mesh.skn) next to the anm files written
+//       (.bnds), so the previews don't skin them again
+//   -j  number of worker threads (default : one per hardware thread)
+//   -q  no line per file, only the totals
+//   -v  show the readers' infos
+// without -o nor -r the files are only read.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <dirent.h>
+#include <errno.h>
+#include <sys/stat.h>
+
+#include <maya/MGlobal.h>
+
+#include <SklData.hpp>
+#include <SknData.hpp>
+#include <Converter.h>
+#include <ThreadPool.h>
+
+using namespace riot;
+
+namespace {
+
+struct Job
+{
+    std::string input;
+    std::string relative; // output path under -o
+    FileFormat format;
+    long long size;
+};
+
+bool isDirectory(const std::string& path)
+{
+    struct stat st;
+    return stat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+long long fileSize(const std::string& path)
+{
+    struct stat st;
+    return stat(path.c_str(), &st) == 0 ? static_cast<long long>(st.st_size) : 0;
+}
+
+std::string baseName(const std::string& path)
+{
+    size_t slash = path.rfind('/');
+    return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+void addFile(const std::string& path, const std::string& relative, std::vector<Job>& jobs)
+{
+    FileFormat format = formatFromName(path);
+    if (format == kUnknownFormat)
+        return;
+
+    Job job;
+    job.input = path;
+    job.relative = relative;
+    job.format = format;
+    job.size = fileSize(path);
+    jobs.push_back(job);
+}
+
+void addDirectory(const std::string& path, const std::string& relative, std::vector<Job>& jobs)
+{
+    DIR* dir = opendir(path.c_str());
+    if (!dir)
+    {
+        fprintf(stderr, "riotconv: %s : could not be opened\n", path.c_str());
+        return;
+    }
+
+    while (struct dirent* entry = readdir(dir))
+    {
+        std::string name = entry->d_name;
+        if (name == "." || name == "..")
+            continue;
+
+        std::string child = path + "/" + name;
+        std::string child_relative = relative.empty() ? name : relative + "/" + name;
+        if (isDirectory(child))
+            addDirectory(child, child_relative, jobs);
+        else
+            addFile(child, child_relative, jobs);
+    }
+    closedir(dir);
+}
+
+bool makeDirectories(const std::string& path)
+{
+    for (size_t slash = path.find('/', 1); ; slash = path.find('/', slash + 1))
+    {
+        std::string dir = path.substr(0, slash);
+        if (mkdir(dir.c_str(), 0755) != 0 && errno != EEXIST)
+            return false;
+        if (slash == std::string::npos)
+            return true;
+    }
+}
+
+// the big ones first, so the pool doesn't end waiting on a single file
+bool biggerFirst(const Job& a, const Job& b)
+{
+    return a.size > b.size;
+}
+
+double toMB(long long bytes)
+{
+    return bytes / (1024.0 * 1024.0);
+}
+
+int usage()
+{
+    fprintf(stderr, "usage: riotconv [-o output_dir] [-r] [-c] [-3|-4] [-f fps] [-k degrees,units] [-b skeleton.skl[,mesh.skn]] [-j threads] [-q] [-v] files or directories...\n");
+    return 2;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    std::string output_dir;
+    bool round_trip = false;
+    bool vertex_cache = false;
+    int anm_version = 0;
+    float anm_fps = 0.0f;
+    float anm_key_angle = 0.0f;
+    float anm_key_position = 0.0f;
+    std::string bounds_skeleton;
+    std::string bounds_mesh;
+    bool quiet = false;
+    int num_threads = 0;
+    std::vector<std::string> inputs;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "-o" && i + 1 < argc)
+            output_dir = argv[++i];
+        else if (arg == "-f" && i + 1 < argc)
+            anm_fps = static_cast<float>(atof(argv[++i]));
+        else if (arg == "-k" && i + 1 < argc)
+        {
+            if (sscanf(argv[++i], "%f,%f", &anm_key_angle, &anm_key_position) != 2)
+                return usage();
+        }
+        else if (arg == "-b" && i + 1 < argc)
+        {
+            bounds_skeleton = argv[++i];
+            size_t comma = bounds_skeleton.find(',');
+            if (comma != std::string::npos)
+            {
+                bounds_mesh = bounds_skeleton.substr(comma + 1);
+                bounds_skeleton.erase(comma);
+            }
+        }
+        else if (arg == "-j" && i + 1 < argc)
+            num_threads = atoi(argv[++i]);
+        else if (arg == "-r")
+            round_trip = true;
+        else if (arg == "-c")
+            vertex_cache = true;
+        else if (arg == "-3")
+            anm_version = 3;
+        else if (arg == "-4")
+            anm_version = 4;
+        else if (arg == "-q")
+            quiet = true;
+        else if (arg == "-v")
+            MGlobal::setVerbose(true);
+        else if (!arg.empty() && arg[0] == '-')
+            return usage();
+        else
+            inputs.push_back(arg);
+    }
+    if (inputs.empty() || (!bounds_skeleton.empty() && output_dir.empty()))
+        return usage();
+
+    // shared by the workers, read only
+    SklData skeleton;
+    SknData mesh;
+    if (!bounds_skeleton.empty() && !readSkeleton(bounds_skeleton, skeleton))
+    {
+        fprintf(stderr, "riotconv: %s : could not be read\n", bounds_skeleton.c_str());
+        return 1;
+    }
+    if (!bounds_mesh.empty() && !readMesh(bounds_mesh, mesh))
+    {
+        fprintf(stderr, "riotconv: %s : could not be read\n", bounds_mesh.c_str());
+        return 1;
+    }
+
+    std::vector<Job> jobs;
+    for (size_t i = 0; i < inputs.size(); i++)
+    {
+        std::string input = inputs[i];
+        while (input.size() > 1 && input[input.size() - 1] == '/')
+            input.erase(input.size() - 1);
+
+        if (isDirectory(input))
+            addDirectory(input, std::string(), jobs);
+        else
+            addFile(input, baseName(input), jobs);
+    }
+    if (jobs.empty())
+    {
+        fprintf(stderr, "riotconv: no skn, skl, anm, scb or sco file found\n");
+        return 1;
+    }
+    std::stable_sort(jobs.begin(), jobs.end(), biggerFirst);
+
+    // the tree is made here, the workers only write files
+    if (!output_dir.empty())
+    {
+        for (size_t i = 0; i < jobs.size(); i++)
+        {
+            std::string path = output_dir + "/" + jobs[i].relative;
+            if (!makeDirectories(path.substr(0, path.rfind('/'))))
+            {
+                fprintf(stderr, "riotconv: %s : could not be created\n", path.c_str());
+                return 1;
+            }
+        }
+    }
+
+    std::vector<ConvertResult> results(jobs.size());
+    std::mutex print_mutex;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    {
+        ThreadPool pool(num_threads);
+        for (size_t i = 0; i < jobs.size(); i++)
+        {
+            pool.push([&, i]()
+            {
+                const Job& job = jobs[i];
+                ConvertOptions options;
+                options.round_trip = round_trip;
+                options.vertex_cache = vertex_cache;
+                options.anm_version = anm_version;
+                options.anm_fps = anm_fps;
+                options.anm_key_angle = anm_key_angle;
+                options.anm_key_position = anm_key_position;
+                if (!bounds_skeleton.empty())
+                    options.bounds_skeleton = &skeleton;
+                if (!bounds_mesh.empty())
+                    options.bounds_mesh = &mesh;
+                if (!output_dir.empty())
+                    options.output_name = output_dir + "/" + job.relative;
+
+                ConvertResult& result = results[i];
+                result = convertFile(job.input, job.format, options);
+
+                if (quiet && result.success)
+                    return;
+                double mb_per_s = result.seconds > 0.0 ? toMB(result.bytes_in) / result.seconds : 0.0;
+                std::lock_guard<std::mutex> lock(print_mutex);
+                printf("%-60s %10.1f KB %9.3f ms %9.1f MB/s  %s\n", job.input.c_str(),
+                       result.bytes_in / 1024.0, result.seconds * 1000.0, mb_per_s,
+                       result.success ? "ok" : ("FAILED: " + result.error).c_str());
+            });
+        }
+        pool.wait();
+        num_threads = pool.size();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    double seconds = elapsed.count();
+
+    int num_failed = 0;
+    long long bytes_in = 0;
+    long long bytes_out = 0;
+    double busy_seconds = 0.0;
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        if (!results[i].success)
+            num_failed++;
+        bytes_in += results[i].bytes_in;
+        bytes_out += results[i].bytes_out;
+        busy_seconds += results[i].seconds;
+    }
+
+    int num_files = static_cast<int>(jobs.size());
+    printf("\n%d file(s), %d failed, %d thread(s)\n", num_files, num_failed, num_threads);
+    printf("read    %.2f MB", toMB(bytes_in));
+    if (bytes_out)
+        printf(", serialized %.2f MB", toMB(bytes_out));
+    printf("\n");
+    printf("time    %.3f s (%.3f s summed over the files)\n", seconds, busy_seconds);
+    if (seconds > 0.0)
+        printf("rate    %.1f files/s, %.1f MB/s\n", num_files / seconds, toMB(bytes_in) / seconds);
+
+    return num_failed ? 1 : 0;
+}
@@ -0,0 +1,43 @@
+/*
+    Copyright 2011 Even Entem (alias ThiSpawn).
+
+    This file is part of Riot File Translator Plug-in for AutoDesk Maya.
+
+    Autodesk Maya's lib is under :
+    Copyright 1995, 2006, 2008 Autodesk, Inc. All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful, 
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef RIOT__HEADLESS__MDAGPATHARRAY_H
+#define RIOT__HEADLESS__MDAGPATHARRAY_H
+
+#include <maya/MDagPath.h>
+
+#include <vector>
+
+class MDagPathArray
+{
+public:
+    unsigned int length() const { return static_cast<unsigned int>(paths_.size()); }
+    void append(const MDagPath& path) { paths_.push_back(path); }
+    void clear() { paths_.clear(); }
+
+    MDagPath& operator[](unsigned int i) { return paths_[i]; }
+    const MDagPath& operator[](unsigned int i) const { return paths_[i]; }
+
+private:
+    std::vector<MDagPath> paths_;
+};
+
+#endif
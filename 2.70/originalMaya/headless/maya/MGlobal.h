@@ -0,0 +1,53 @@
+/*
+    Copyright 2011 Even Entem (alias ThiSpawn).
+
+    This file is part of Riot File Translator Plug-in for AutoDesk Maya.
+
+    Autodesk Maya's lib is under :
+    Copyright 1995, 2006, 2008 Autodesk, Inc. All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful, 
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef RIOT__HEADLESS__MGLOBAL_H
+#define RIOT__HEADLESS__MGLOBAL_H
+
+#include <maya/MString.h>
+
+#include <cstdio>
+
+// messages go to stderr, one fprintf each so lines from different threads
+// don't get mixed. infos are only shown once setVerbose(true) is called.
+class MGlobal
+{
+public:
+    static void displayError(const MString& msg) { fprintf(stderr, "error: %s\n", msg.asChar()); }
+    static void displayWarning(const MString& msg) { fprintf(stderr, "warning: %s\n", msg.asChar()); }
+    static void displayInfo(const MString& msg)
+    {
+        if (verbose())
+            fprintf(stderr, "%s\n", msg.asChar());
+    }
+
+    // not in maya
+    static void setVerbose(bool verbose_on) { verbose() = verbose_on; }
+
+private:
+    static bool& verbose()
+    {
+        static bool verbose_on = false;
+        return verbose_on;
+    }
+};
+
+#endif
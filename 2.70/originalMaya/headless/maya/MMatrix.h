@@ -0,0 +1,51 @@
+/*
+    Copyright 2011 Even Entem (alias ThiSpawn).
+
+    This file is part of Riot File Translator Plug-in for AutoDesk Maya.
+
+    Autodesk Maya's lib is under :
+    Copyright 1995, 2006, 2008 Autodesk, Inc. All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful, 
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef RIOT__HEADLESS__MMATRIX_H
+#define RIOT__HEADLESS__MMATRIX_H
+
+#include <maya/MTypes.h>
+
+// row major, translation on the last row, as in maya
+class MMatrix
+{
+public:
+    MMatrix()
+    {
+        for (int i = 0; i < 4; i++)
+            for (int j = 0; j < 4; j++)
+                matrix[i][j] = (i == j) ? 1.0 : 0.0;
+    }
+
+    MMatrix(const float src[4][4])
+    {
+        for (int i = 0; i < 4; i++)
+            for (int j = 0; j < 4; j++)
+                matrix[i][j] = src[i][j];
+    }
+
+    double* operator[](unsigned int row) { return matrix[row]; }
+    const double* operator[](unsigned int row) const { return matrix[row]; }
+
+    double matrix[4][4];
+};
+
+#endif
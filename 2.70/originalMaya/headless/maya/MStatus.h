@@ -0,0 +1,58 @@
+/*
+    Copyright 2011 Even Entem (alias ThiSpawn).
+
+    This file is part of Riot File Translator Plug-in for AutoDesk Maya.
+
+    Autodesk Maya's lib is under :
+    Copyright 1995, 2006, 2008 Autodesk, Inc. All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful, 
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef RIOT__HEADLESS__MSTATUS_H
+#define RIOT__HEADLESS__MSTATUS_H
+
+#include <maya/MTypes.h>
+#include <maya/MString.h>
+
+class MStatus
+{
+public:
+    enum MStatusCode
+    {
+        kSuccess = 0,
+        kFailure
+    };
+
+    MStatus(MStatusCode code = kSuccess) : code_(code) {}
+
+    bool operator==(MStatusCode code) const { return code_ == code; }
+    bool operator!=(MStatusCode code) const { return code_ != code; }
+    bool operator==(const MStatus& other) const { return code_ == other.code_; }
+    bool operator!=(const MStatus& other) const { return code_ != other.code_; }
+    operator bool() const { return code_ == kSuccess; }
+
+    MStatusCode statusCode() const { return code_; }
+    MString errorString() const { return code_ == kSuccess ? "success" : "failure"; }
+
+private:
+    MStatusCode code_;
+};
+
+// so "MStatus::kFailure == status" doesn't go through operator bool
+inline bool operator==(MStatus::MStatusCode code, const MStatus& status) { return status == code; }
+inline bool operator!=(MStatus::MStatusCode code, const MStatus& status) { return status != code; }
+
+typedef MStatus MS;
+
+#endif
@@ -0,0 +1,88 @@
+/*
+    Copyright 2011 Even Entem (alias ThiSpawn).
+
+    This file is part of Riot File Translator Plug-in for AutoDesk Maya.
+
+    Autodesk Maya's lib is under :
+    Copyright 1995, 2006, 2008 Autodesk, Inc. All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful, 
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef RIOT__HEADLESS__MSTRING_H
+#define RIOT__HEADLESS__MSTRING_H
+
+#include <maya/MTypes.h>
+
+#include <string>
+#include <sstream>
+#include <ostream>
+
+class MString
+{
+public:
+    MString() {}
+    MString(const char* str) : str_(str ? str : "") {}
+
+    const char* asChar() const { return str_.c_str(); }
+    unsigned int length() const { return static_cast<unsigned int>(str_.size()); }
+
+    // start and end are both included, as in maya
+    MString substring(int start, int end) const
+    {
+        return MString(str_.substr(start, end - start + 1).c_str());
+    }
+
+    MString& operator+=(const MString& other) { str_ += other.str_; return *this; }
+    MString& operator+=(const char* other) { str_ += other; return *this; }
+    MString& operator+=(int value) { return append(value); }
+    MString& operator+=(unsigned int value) { return append(value); }
+    MString& operator+=(double value) { return append(value); }
+
+    template <class T>
+    MString operator+(const T& other) const
+    {
+        MString ret(*this);
+        ret += other;
+        return ret;
+    }
+
+    bool operator==(const MString& other) const { return str_ == other.str_; }
+    bool operator!=(const MString& other) const { return str_ != other.str_; }
+    bool operator==(const char* other) const { return str_ == other; }
+    bool operator!=(const char* other) const { return str_ != other; }
+
+private:
+    template <class T>
+    MString& append(T value)
+    {
+        std::ostringstream out;
+        out << value;
+        str_ += out.str();
+        return *this;
+    }
+
+    std::string str_;
+};
+
+inline MString operator+(const char* left, const MString& right)
+{
+    return MString(left) + right;
+}
+
+inline std::ostream& operator<<(std::ostream& out, const MString& str)
+{
+    return out << str.asChar();
+}
+
+#endif
@@ -0,0 +1,84 @@
+/*
+    Copyright 2011 Even Entem (alias ThiSpawn).
+
+    This file is part of Riot File Translator Plug-in for AutoDesk Maya.
+
+    Autodesk Maya's lib is under :
+    Copyright 1995, 2006, 2008 Autodesk, Inc. All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful, 
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef RIOT__HEADLESS__MTRANSFORMATIONMATRIX_H
+#define RIOT__HEADLESS__MTRANSFORMATIONMATRIX_H
+
+#include <cmath>
+
+#include <maya/MTypes.h>
+#include <maya/MMatrix.h>
+#include <maya/MVector.h>
+
+// only rotation (as a quaternion) and translation, which is all the
+// readers build. the space argument is ignored.
+class MTransformationMatrix
+{
+public:
+    MTransformationMatrix()
+        : qx_(0.0), qy_(0.0), qz_(0.0), qw_(1.0)
+    {
+    }
+
+    void setTranslation(const MVector& translation, MSpace::Space /*space*/)
+    {
+        translation_ = translation;
+    }
+
+    void setRotationQuaternion(double x, double y, double z, double w, MSpace::Space /*space*/ = MSpace::kTransform)
+    {
+        double length = sqrt(x * x + y * y + z * z + w * w);
+        if (length == 0.0)
+            length = 1.0;
+        qx_ = x / length;
+        qy_ = y / length;
+        qz_ = z / length;
+        qw_ = w / length;
+    }
+
+    MMatrix asMatrix() const
+    {
+        double x = qx_, y = qy_, z = qz_, w = qw_;
+        MMatrix mat;
+        mat[0][0] = 1.0 - 2.0 * (y * y + z * z);
+        mat[0][1] = 2.0 * (x * y + z * w);
+        mat[0][2] = 2.0 * (x * z - y * w);
+        mat[1][0] = 2.0 * (x * y - z * w);
+        mat[1][1] = 1.0 - 2.0 * (x * x + z * z);
+        mat[1][2] = 2.0 * (y * z + x * w);
+        mat[2][0] = 2.0 * (x * z + y * w);
+        mat[2][1] = 2.0 * (y * z - x * w);
+        mat[2][2] = 1.0 - 2.0 * (x * x + y * y);
+        mat[3][0] = translation_.x;
+        mat[3][1] = translation_.y;
+        mat[3][2] = translation_.z;
+        return mat;
+    }
+
+private:
+    MVector translation_;
+    double qx_;
+    double qy_;
+    double qz_;
+    double qw_;
+};
+
+#endif
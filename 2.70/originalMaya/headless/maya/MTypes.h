@@ -0,0 +1,115 @@
+/*
+    Copyright 2011 Even Entem (alias ThiSpawn).
+
+    This file is part of Riot File Translator Plug-in for AutoDesk Maya.
+
+    Autodesk Maya's lib is under :
+    Copyright 1995, 2006, 2008 Autodesk, Inc. All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful, 
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef RIOT__HEADLESS__MTYPES_H
+#define RIOT__HEADLESS__MTYPES_H
+
+// headless stand-ins for the parts of the maya api used by the readers and
+// writers. every maya header includes this one, so it also carries what the
+// msvc runtime provides to the plug-in.
+
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdarg>
+#include <strings.h>
+
+typedef unsigned short USHORT;
+typedef unsigned short WORD;
+
+inline int strcpy_s(char* dst, size_t size, const char* src)
+{
+    size_t length = strlen(src);
+    if (length >= size)
+        length = size - 1;
+    memcpy(dst, src, length);
+    dst[length] = '\0';
+    return 0;
+}
+
+// msvc takes a buffer size after the pointer of each %s %c and %[,
+// they are dropped and the pointers handed to sscanf.
+inline int sscanf_s(const char* buffer, const char* format, ...)
+{
+    const int kMaxFields = 16;
+    void* fields[kMaxFields] = {0};
+    int num_fields = 0;
+
+    va_list args;
+    va_start(args, format);
+    for (const char* c = format; *c && num_fields < kMaxFields; c++)
+    {
+        if (*c != '%')
+            continue;
+        c++;
+        if (*c == '%')
+            continue;
+        bool suppressed = (*c == '*');
+        while (*c && strchr("*0123456789hlLqjzt", *c))
+            c++;
+        if (!*c)
+            break;
+        if (suppressed)
+            continue;
+        fields[num_fields++] = va_arg(args, void*);
+        if (*c == 's' || *c == 'c' || *c == '[')
+            va_arg(args, unsigned int);
+        if (*c == '[')
+        {
+            // a ] right after [ or [^ is part of the set
+            c++;
+            if (*c == '^')
+                c++;
+            if (*c == ']')
+                c++;
+            while (*c && *c != ']')
+                c++;
+            if (!*c)
+                break;
+        }
+    }
+    va_end(args);
+
+    return sscanf(buffer, format,
+                  fields[0], fields[1], fields[2], fields[3], fields[4], fields[5], fields[6], fields[7],
+                  fields[8], fields[9], fields[10], fields[11], fields[12], fields[13], fields[14], fields[15]);
+}
+
+#define strtok_s strtok_r
+#define _strnicmp strncasecmp
+#define _stricmp strcasecmp
+
+class MSpace
+{
+public:
+    enum Space
+    {
+        kInvalid = 0,
+        kTransform,
+        kPreTransform,
+        kPostTransform,
+        kWorld,
+        kLast,
+        kObject = kPreTransform
+    };
+};
+
+#endif
@@ -0,0 +1,38 @@
+/*
+    Copyright 2011 Even Entem (alias ThiSpawn).
+
+    This file is part of Riot File Translator Plug-in for AutoDesk Maya.
+
+    Autodesk Maya's lib is under :
+    Copyright 1995, 2006, 2008 Autodesk, Inc. All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful, 
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef RIOT__HEADLESS__MVECTOR_H
+#define RIOT__HEADLESS__MVECTOR_H
+
+#include <maya/MTypes.h>
+
+class MVector
+{
+public:
+    MVector() : x(0.0), y(0.0), z(0.0) {}
+    MVector(double xx, double yy, double zz) : x(xx), y(yy), z(zz) {}
+
+    double x;
+    double y;
+    double z;
+};
+
+#endif
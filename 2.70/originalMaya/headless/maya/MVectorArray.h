@@ -0,0 +1,50 @@
+/*
+    Copyright 2011 Even Entem (alias ThiSpawn).
+
+    This file is part of Riot File Translator Plug-in for AutoDesk Maya.
+
+    Autodesk Maya's lib is under :
+    Copyright 1995, 2006, 2008 Autodesk, Inc. All rights reserved.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful, 
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef RIOT__HEADLESS__MVECTORARRAY_H
+#define RIOT__HEADLESS__MVECTORARRAY_H
+
+#include <maya/MVector.h>
+
+#include <vector>
+
+class MVectorArray
+{
+public:
+    MVectorArray() {}
+    MVectorArray(const float src[][3], unsigned int count)
+    {
+        for (unsigned int i = 0; i < count; i++)
+            values_.push_back(MVector(src[i][0], src[i][1], src[i][2]));
+    }
+
+    unsigned int length() const { return static_cast<unsigned int>(values_.size()); }
+    void append(const MVector& value) { values_.push_back(value); }
+    void clear() { values_.clear(); }
+
+    MVector& operator[](unsigned int i) { return values_[i]; }
+    const MVector& operator[](unsigned int i) const { return values_[i]; }
+
+private:
+    std::vector<MVector> values_;
+};
+
+#endif
@@ -38,6 +38,7 @@
 #include <freezeRot.h>
 #include <resetBindPose.h>
 #include <fixAnim.h>
+#include <importAnims.h>
 #include <maya_misc.h>
 
 MStatus initializePlugin(MObject obj)
@@ -136,6 +137,12 @@ MStatus initializePlugin(MObject obj)
         return status;
     }
     riot::FixAnimCmd::initialize();
+    status = plugin.registerCommand("importAnims", riot::ImportAnimsCmd::creator);
+    if (!status)
+    {
+        status.perror("registerCommand(\"importAnims\"..");
+        return status;
+    }
 
     //MGlobal::executeCommand("shelfLayout -e -cellHeight 35 Riot");
     //MGlobal::executeCommand("shelfLayout -e -cellWidth 35 Riot");
@@ -228,6 +235,12 @@ MStatus uninitializePlugin(MObject obj)
         status.perror("deregisterCommand(\"fixAnim\")");
         return status;
     }
+    status =  plugin.deregisterCommand("importAnims");
+    if (!status)
+    {
+        status.perror("deregisterCommand(\"importAnims\")");
+        return status;
+    }
 
     MGlobal::executeCommand("deleteShelfTabNC Riot");
 
@@ -22,6 +22,8 @@
 
 #include <maya_misc.h>
 
+#include <ctype.h>
+
 #include <maya/MIntArray.h>
 #include <maya/MGlobal.h>
 #include <maya/MStringArray.h>
@@ -29,6 +31,8 @@
 
 namespace riot {
 
+#ifndef RIOT_HEADLESS
+
 MPlug firstNotConnectedElement(MPlug& plug)
 {
     MPlug ret_plug;
@@ -95,6 +99,8 @@ void deleteRiotTab(void* /*clientData*/)
     MGlobal::executeCommand("deleteShelfTabNC Riot");
 }
 
+#endif // RIOT_HEADLESS
+
 int hashName(const char* name)
 {
     int i = 0;